@@ -1,17 +1,25 @@
 #include "ALPGunDetectorConstruction.hh"
 #include "ALPGunActionInitialization.hh"
-#ifdef G4MULTITHREADED
+#include "ALPGunScoreWriter.hh"
+#include "ALPGunMscRegionPhysics.hh"
+#include "G4Version.hh"
+#if G4VERSION_NUMBER >= 1130
+#include "G4RunManagerFactory.hh"
+#elif defined(G4MULTITHREADED)
 #include "G4MTRunManager.hh"
 #else
 #include "G4RunManager.hh"
 #endif
 
 #include "G4UImanager.hh"
+#include "G4ScoringManager.hh"
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 
 #include "Randomize.hh"
-#include "FTFP_BERT_HP.hh" 
+#include "G4PhysListFactory.hh"
+
+#include <cstdlib>
 
 int main(int argc,char** argv)
 {
@@ -22,14 +30,31 @@ int main(int argc,char** argv)
 
   G4Random::setTheEngine(new CLHEP::RanecuEngine);
   
-#ifdef G4MULTITHREADED
+#if G4VERSION_NUMBER >= 1130
+  // G4RUN_MANAGER_TYPE=SubEvt splits single large events over the worker
+  // threads, see ALPGunStackingAction
+  G4RunManager* runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::MT, false);
+  if (runManager->GetRunManagerType() == G4RunManager::subEventMasterRM) {
+    // Sub-event type 0 carries up to 100 offloaded secondaries
+    runManager->RegisterSubEventType(0, 100);
+  }
+#elif defined(G4MULTITHREADED)
   G4MTRunManager* runManager = new G4MTRunManager;
 #else
   G4RunManager* runManager = new G4RunManager;
 #endif
 
+  // Enables the /score/ mesh commands, see scoring.mac; grids are dumped in binary
+  G4ScoringManager* scoringManager = G4ScoringManager::GetScoringManager();
+  scoringManager->SetScoreWriter(new ALPGunScoreWriter());
+
   runManager->SetUserInitialization(new ALPGunDetectorConstruction());
-  runManager->SetUserInitialization(new FTFP_BERT_HP());
+  // PHYSLIST=<reference list> swaps the physics list, e.g. for validate.py
+  G4PhysListFactory physListFactory;
+  const char* physList = std::getenv("PHYSLIST");
+  G4VModularPhysicsList* physicsList = physListFactory.GetReferencePhysList(physList ? physList : "FTFP_BERT_HP");
+  physicsList->RegisterPhysics(new ALPGunMscRegionPhysics());
+  runManager->SetUserInitialization(physicsList);
   runManager->SetUserInitialization(new ALPGunActionInitialization());
   G4VisManager* visManager = new G4VisExecutive;
   visManager->Initialize();
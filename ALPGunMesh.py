@@ -0,0 +1,38 @@
+import struct
+import numpy as np
+
+# Reader for the binary grids written by ALPGunScoreWriter
+# (/score/dumpQuantityToFile and /score/dumpAllQuantitiesToFile).
+#
+#   grids = readMesh('targetMesh.bin')
+#   dose = grids['dose']['values']   # numpy array of shape nBins, in grids['dose']['unit']
+#
+# The axes of 'values' are listed in grids[...]['axes']: x, y, z for a box mesh
+# and z, phi, r for a cylinder mesh, as stored by Geant4; /score/mesh/nBin takes
+# the cylinder bins in r, z, phi order.
+
+def _string(f):
+    n, = struct.unpack('=H', f.read(2))
+    return f.read(n).decode()
+
+def readMesh(path):
+    grids = {}
+    with open(path, 'rb') as f:
+        while True:
+            magic = f.read(8)
+            if not magic:
+                return grids
+            if magic != b'ALPGMESH':
+                raise ValueError('{} is not an ALPGun mesh file'.format(path))
+            version, shape = struct.unpack('=IB', f.read(5))
+            nBins = struct.unpack('=3I', f.read(12))
+            size = struct.unpack('=3d', f.read(24))
+            translation = struct.unpack('=3d', f.read(24))
+            mesh, quantity, unit = _string(f), _string(f), _string(f)
+            count = nBins[0] * nBins[1] * nBins[2]
+            values = np.frombuffer(f.read(4 * count), dtype=np.float32).reshape(nBins)
+            grids[quantity] = {
+                'mesh': mesh, 'shape': 'cylinder' if shape == 1 else 'box', 'unit': unit,
+                'axes': ('z', 'phi', 'r') if shape == 1 else ('x', 'y', 'z'),
+                'size_mm': size, 'translation_mm': translation, 'values': values,
+            }
@@ -0,0 +1,72 @@
+import os, socket, struct
+import numpy as np
+
+# Reader for the ALPGun "/output/backend stream" format (see include/ALPGunOutput.hh).
+#
+#   for batch in readStream('ALPGun.stream'):
+#       print(len(batch['E']), batch['PPIPZ'].sum())
+#
+# Every batch is a dict of numpy arrays keyed by the DAMSA column names.
+
+TYPES = {1: np.float64}
+
+def _readExact(f, n):
+    buf = bytearray()
+    while len(buf) < n:
+        chunk = f.read(n - len(buf))
+        if not chunk:
+            raise EOFError('stream ended after {} of {} bytes'.format(len(buf), n))
+        buf += chunk
+    return bytes(buf)
+
+def _open(path):
+    if path.startswith('unix:'):
+        path = path[5:]
+        if os.path.exists(path): os.remove(path)
+        srv = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        srv.bind(path)
+        srv.listen(1)
+        conn, _ = srv.accept()
+        srv.close()
+        return conn.makefile('rb')
+    if not os.path.exists(path): os.mkfifo(path)
+    return open(path, 'rb')
+
+def readStream(path):
+    """Yield record batches as soon as the simulation writes them.
+
+    Raises EOFError if the stream ends without its trailer and ValueError if
+    the trailer row count does not match the rows received."""
+    with _open(path) as f:
+        if _readExact(f, 8) != b'ALPGSTRM':
+            raise ValueError('{} is not an ALPGun stream'.format(path))
+        version, nCol = struct.unpack('=II', _readExact(f, 8))
+        columns = []
+        for _ in range(nCol):
+            typ, length = struct.unpack('=BH', _readExact(f, 3))
+            columns.append((_readExact(f, length).decode(), TYPES[typ]))
+
+        received = 0
+        while True:
+            tag = _readExact(f, 4)
+            if tag == b'END\0':
+                total, = struct.unpack('=Q', _readExact(f, 8))
+                if total != received:
+                    raise ValueError('truncated stream: trailer announces {} rows, received {}'.format(total, received))
+                return
+            if tag != b'BTCH':
+                raise ValueError('corrupt stream: unexpected tag {!r}'.format(tag))
+            nRows, = struct.unpack('=I', _readExact(f, 4))
+            received += nRows
+            batch = {}
+            for name, typ in columns:
+                size = nRows * np.dtype(typ).itemsize
+                batch[name] = np.frombuffer(_readExact(f, size), dtype=typ)
+            yield batch
+
+if __name__ == '__main__':
+    import sys
+    nRows = 0
+    for batch in readStream(sys.argv[1] if len(sys.argv) > 1 else 'ALPGun.stream'):
+        nRows += len(batch['evtID'])
+        print('{} rows'.format(nRows))
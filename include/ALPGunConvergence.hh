@@ -0,0 +1,55 @@
+#ifndef ALPGunConvergence_h
+#define ALPGunConvergence_h 1
+
+#include "G4GenericMessenger.hh"
+#include "globals.hh"
+
+#include <mutex>
+
+// Running statistics of one per-event observable, shared by all workers.
+//
+// The observable is the summed Gap energy of an event (optionally of one
+// layer only) or its sampling fraction Gap/(Gap + Absorber). Once the relative
+// precision of the selected target (mean, RMS or mean sampling fraction)
+// reaches the goal, AddEvent() returns true and the event action asks its run
+// manager for a soft abort. Every worker stops only once it finishes its own
+// next event, so a run overshoots by up to one event per other worker.
+// maxEvents is a hard cap on top of the /run/beamOn count, subject to the
+// same overshoot. It counts every event, including those that miss the stack
+// and give no sampling fraction.
+class ALPGunConvergence
+{
+  public:
+    static ALPGunConvergence* Instance();
+
+    G4bool IsEnabled() const { return fEnabled; }
+    G4int GetLayer() const { return fLayer; }
+
+    void BeginRun();
+    G4bool AddEvent(G4double gapEnergy, G4double absorberEnergy);
+    void Report() const;
+
+  private:
+    ALPGunConvergence();
+    ~ALPGunConvergence();
+
+    G4double Value() const;
+    G4double RelativeError() const;
+    G4bool Done() const;
+
+    G4GenericMessenger* messenger;
+    G4bool fEnabled;
+    G4String fTarget;
+    G4double fPrecision;
+    G4int fLayer;
+    G4int fMinEvents;
+    G4int fMaxEvents;
+
+    mutable std::mutex fMutex;
+    G4int fNEvents;
+    G4int fN;
+    G4double fMean, fM2, fM3, fM4;
+    G4bool fConverged;
+};
+
+#endif
@@ -18,12 +18,17 @@ class ALPGunDetectorConstruction : public G4VUserDetectorConstruction
     G4double m_absorberLength, m_gapLength;
     G4int m_numLayers;
     G4String m_absorber_mat;
+    G4bool fCheckOverlaps;
+    G4bool fUseCache, fRevalidate;
+    G4String fCacheDir;
+    G4bool fNavigationProfile;
           
   public:
     ALPGunDetectorConstruction();
     virtual ~ALPGunDetectorConstruction();
     
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField();
     
     G4LogicalVolume* GetScoringVolume1() const { return fScoringVolume1; }
     G4LogicalVolume* GetScoringVolume2() const { return fScoringVolume2; }
@@ -32,6 +37,9 @@ class ALPGunDetectorConstruction : public G4VUserDetectorConstruction
     G4double GetTargetLength() const { return targetLength;}
 
   protected: 
+    G4VPhysicalVolume* ConstructGeometry();
+    G4VPhysicalVolume* ConstructCached();
+    void ConfigureNavigation();
     
     G4LogicalVolume*  fScoringVolume1;
     G4LogicalVolume*  fScoringVolume2;
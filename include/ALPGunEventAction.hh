@@ -0,0 +1,56 @@
+#ifndef ALPGunEventAction_h
+#define ALPGunEventAction_h 1
+
+#include "G4UserEventAction.hh"
+#include "G4Version.hh"
+#include "ALPGunEventInfo.hh"
+#include "ALPGunEventTrigger.hh"
+#include "ALPGunRow.hh"
+#include "globals.hh"
+
+class ALPGunGapDigitizer;
+class ALPGunRunAction;
+
+class ALPGunEventAction : public G4UserEventAction
+{
+  public:
+    ALPGunEventAction(const ALPGunRunAction* runAction);
+    virtual ~ALPGunEventAction();
+
+    virtual void BeginOfEventAction(const G4Event*);
+    virtual void EndOfEventAction(const G4Event*);
+#if G4VERSION_NUMBER >= 1130
+    // Nothing to merge, see ALPGunStackingAction
+    virtual void MergeSubEvent(G4Event*, const G4Event*) {}
+#endif
+
+    G4bool IsDigitizing() const;
+
+    // Trigger, digitization, summary and adaptive termination see an event
+    // only as a whole, which rules out handing parts of it to sub-events
+    G4bool NeedsCompleteEvents() const;
+
+    void AddGapEdep(G4int layer, G4double edep) { fInfo->AddGapEdep(layer, edep); }
+    void AddAbsorberEdep(G4int layer, G4double edep) { fInfo->AddAbsorberEdep(layer, edep); }
+    void AddRadialEdep(G4double r, G4double edep) { fInfo->AddRadialEdep(r, edep); }
+    void CountTrack(G4int pdg) { fInfo->CountTrack(pdg); }
+    void CountStep() { fInfo->CountStep(); }
+    void AddEntranceEnergy(G4int layer, G4double ekin) { fInfo->AddEntranceEnergy(layer, ekin); }
+
+    // Rows are held back until the trigger has seen the whole event
+    G4bool IsBuffering() const { return fTrigger.IsEnabled(); }
+    void BufferRow(const ALPGunRow& row) { fInfo->BufferRow(row); }
+
+  private:
+    static G4bool IsSubEvent(const G4Event* event);
+    void WriteDigis(const G4Event* event);
+    void WriteSummary(const G4Event* event);
+
+    const ALPGunRunAction* fRunAction;
+    ALPGunGapDigitizer* fDigitizer;
+    G4int fDCID;
+    ALPGunEventInfo* fInfo;
+    ALPGunEventTrigger fTrigger;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef ALPGunEventInfo_h
+#define ALPGunEventInfo_h 1
+
+#include "G4VUserEventInformation.hh"
+#include "ALPGunRow.hh"
+#include "globals.hh"
+
+#include <vector>
+
+// Per-layer and radial energy sums and track multiplicities of one event,
+// attached to the G4Event by ALPGunEventAction.
+class ALPGunEventInfo : public G4VUserEventInformation
+{
+  public:
+    enum Species { kGamma, kElectron, kPositron, kNeutron, kProton, kOther, nSpecies };
+    static const G4int nRadialBins = 10;
+    static const G4double radialBinWidth;
+
+    ALPGunEventInfo();
+    virtual ~ALPGunEventInfo();
+
+    virtual void Print() const;
+
+    void AddGapEdep(G4int layer, G4double edep) { Add(fGapEdep, layer, edep); }
+    void AddAbsorberEdep(G4int layer, G4double edep) { Add(fAbsorberEdep, layer, edep); }
+
+    // layer < 0 sums the whole stack
+    G4double GetGapEdep(G4int layer) const { return Sum(fGapEdep, layer); }
+    G4double GetAbsorberEdep(G4int layer) const { return Sum(fAbsorberEdep, layer); }
+
+    G4int GetNumberOfGapLayersHit() const;
+
+    // Kinetic energy of the tracks entering the Absorber of a layer
+    void AddEntranceEnergy(G4int layer, G4double ekin) { Add(fEntranceEnergy, layer, ekin); }
+    G4double GetEntranceEnergy(G4int layer) const { return Sum(fEntranceEnergy, layer); }
+
+    // Deposits beyond the last bin go into the last bin
+    void AddRadialEdep(G4double r, G4double edep);
+    G4double GetRadialEdep(G4int bin) const { return fRadialEdep[bin]; }
+
+    void CountTrack(G4int pdg);
+    G4int GetMultiplicity(G4int species) const { return fMultiplicity[species]; }
+
+    void CountStep() { ++fNSteps; }
+    G4int GetNumberOfSteps() const { return fNSteps; }
+
+    // DAMSA rows held back until the trigger has seen the whole event
+    void BufferRow(const ALPGunRow& row) { fRows.push_back(row); }
+    const std::vector<ALPGunRow>& GetRows() const { return fRows; }
+
+  private:
+    static void Add(std::vector<G4double>& perLayer, G4int layer, G4double edep);
+    static G4double Sum(const std::vector<G4double>& perLayer, G4int layer);
+
+    std::vector<G4double> fGapEdep;
+    std::vector<G4double> fAbsorberEdep;
+    std::vector<G4double> fEntranceEnergy;
+    G4double fRadialEdep[nRadialBins];
+    G4int fMultiplicity[nSpecies];
+    G4int fNSteps;
+    std::vector<ALPGunRow> fRows;
+};
+
+#endif
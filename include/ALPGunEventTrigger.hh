@@ -0,0 +1,35 @@
+#ifndef ALPGunEventTrigger_h
+#define ALPGunEventTrigger_h 1
+
+#include "G4GenericMessenger.hh"
+#include "globals.hh"
+
+class ALPGunEventInfo;
+
+// End-of-event trigger deciding whether the buffered rows and the digis of an
+// event are written. All enabled conditions must hold:
+//   minGapEnergy      summed Gap energy of the event
+//   minLayersHit      number of Gap layers with a deposit
+//   minEntranceEnergy summed kinetic energy entering the Absorber of
+//                     entranceLayer (disabled for entranceLayer < 0)
+// No tracks are offloaded to sub-events while the trigger is enabled, so it
+// always judges the whole event.
+class ALPGunEventTrigger
+{
+  public:
+    ALPGunEventTrigger();
+    ~ALPGunEventTrigger();
+
+    G4bool IsEnabled() const { return fEnabled; }
+    G4bool Accept(const ALPGunEventInfo& info) const;
+
+  private:
+    G4GenericMessenger* messenger;
+    G4bool fEnabled;
+    G4double fMinGapEnergy;
+    G4int fMinLayersHit;
+    G4int fEntranceLayer;
+    G4double fMinEntranceEnergy;
+};
+
+#endif
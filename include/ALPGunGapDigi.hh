@@ -0,0 +1,51 @@
+#ifndef ALPGunGapDigi_h
+#define ALPGunGapDigi_h 1
+
+#include "G4VDigi.hh"
+#include "G4TDigiCollection.hh"
+#include "G4Allocator.hh"
+#include "globals.hh"
+
+// Zero-suppressed pad signal of one Gap layer
+class ALPGunGapDigi : public G4VDigi
+{
+  public:
+    ALPGunGapDigi();
+    virtual ~ALPGunGapDigi();
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    void SetLayer(G4int layer) { fLayer = layer; }
+    void SetPad(G4int pad) { fPad = pad; }
+    void SetCharge(G4double charge) { fCharge = charge; }
+    void SetTime(G4double t) { fTime = t; }
+
+    G4int GetLayer() const { return fLayer; }
+    G4int GetPad() const { return fPad; }
+    G4double GetCharge() const { return fCharge; }
+    G4double GetTime() const { return fTime; }
+
+  private:
+    G4int fLayer;
+    G4int fPad;
+    G4double fCharge;
+    G4double fTime;
+};
+
+typedef G4TDigiCollection<ALPGunGapDigi> ALPGunGapDigiCollection;
+
+extern G4ThreadLocal G4Allocator<ALPGunGapDigi>* ALPGunGapDigiAllocator;
+
+inline void* ALPGunGapDigi::operator new(size_t)
+{
+  if (!ALPGunGapDigiAllocator) ALPGunGapDigiAllocator = new G4Allocator<ALPGunGapDigi>;
+  return (void*)ALPGunGapDigiAllocator->MallocSingle();
+}
+
+inline void ALPGunGapDigi::operator delete(void* digi)
+{
+  ALPGunGapDigiAllocator->FreeSingle((ALPGunGapDigi*)digi);
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef ALPGunGapDigitizer_h
+#define ALPGunGapDigitizer_h 1
+
+#include "G4VDigitizerModule.hh"
+#include "G4GenericMessenger.hh"
+#include "globals.hh"
+
+// Turns the Gap energy deposits into zero-suppressed pad signals.
+//
+// Each deposit is converted to drift electrons (edep / W), multiplied by the
+// gas gain and spread over the pad plane with a Gaussian whose width grows with
+// the square root of the drift distance to the readout (Cu) side of the gap.
+// Gaussian electronics noise is added to every pad that collected charge and
+// only pads above threshold are kept. Charges are in fC. Switched on with
+// /digi/enable, which lives in ALPGunRunAction.
+class ALPGunGapDigitizer : public G4VDigitizerModule
+{
+  public:
+    ALPGunGapDigitizer(const G4String& name);
+    virtual ~ALPGunGapDigitizer();
+
+    virtual void Digitize();
+
+  private:
+    G4GenericMessenger* messenger;
+    G4double fPadPitch;
+    G4double fWValue;
+    G4double fGain;
+    G4double fDiffusion;
+    G4double fNoise;
+    G4double fTimeWindow;
+    G4double fThreshold;
+    G4int fHCID;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef ALPGunGapHit_h
+#define ALPGunGapHit_h 1
+
+#include "G4VHit.hh"
+#include "G4THitsCollection.hh"
+#include "G4Allocator.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+// Energy deposit of one step in an Ar/CO2 gap, in the local frame of the gap
+class ALPGunGapHit : public G4VHit
+{
+  public:
+    ALPGunGapHit();
+    virtual ~ALPGunGapHit();
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    void SetLayer(G4int layer) { fLayer = layer; }
+    void SetEdep(G4double edep) { fEdep = edep; }
+    void SetTime(G4double t) { fTime = t; }
+    void SetLocalPos(const G4ThreeVector& pos) { fLocalPos = pos; }
+    void SetHalfSize(const G4ThreeVector& half) { fHalfSize = half; }
+
+    G4int GetLayer() const { return fLayer; }
+    G4double GetEdep() const { return fEdep; }
+    G4double GetTime() const { return fTime; }
+    const G4ThreeVector& GetLocalPos() const { return fLocalPos; }
+    const G4ThreeVector& GetHalfSize() const { return fHalfSize; }
+
+  private:
+    G4int fLayer;
+    G4double fEdep;
+    G4double fTime;
+    G4ThreeVector fLocalPos;
+    G4ThreeVector fHalfSize;
+};
+
+typedef G4THitsCollection<ALPGunGapHit> ALPGunGapHitsCollection;
+
+extern G4ThreadLocal G4Allocator<ALPGunGapHit>* ALPGunGapHitAllocator;
+
+inline void* ALPGunGapHit::operator new(size_t)
+{
+  if (!ALPGunGapHitAllocator) ALPGunGapHitAllocator = new G4Allocator<ALPGunGapHit>;
+  return (void*)ALPGunGapHitAllocator->MallocSingle();
+}
+
+inline void ALPGunGapHit::operator delete(void* hit)
+{
+  ALPGunGapHitAllocator->FreeSingle((ALPGunGapHit*)hit);
+}
+
+#endif
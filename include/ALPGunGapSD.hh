@@ -0,0 +1,24 @@
+#ifndef ALPGunGapSD_h
+#define ALPGunGapSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+#include "ALPGunGapHit.hh"
+
+class G4Step;
+class G4HCofThisEvent;
+
+// Collects the energy deposits in the Gap layers for the digitization stage
+class ALPGunGapSD : public G4VSensitiveDetector
+{
+  public:
+    ALPGunGapSD(const G4String& name, const G4String& hitsCollectionName);
+    virtual ~ALPGunGapSD();
+
+    virtual void Initialize(G4HCofThisEvent*);
+    virtual G4bool ProcessHits(G4Step*, G4TouchableHistory*);
+
+  private:
+    ALPGunGapHitsCollection* fHitsCollection;
+};
+
+#endif
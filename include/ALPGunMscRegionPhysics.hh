@@ -0,0 +1,22 @@
+#ifndef ALPGunMscRegionPhysics_h
+#define ALPGunMscRegionPhysics_h 1
+
+#include "G4VPhysicsConstructor.hh"
+#include "globals.hh"
+
+// Per-region multiple scattering step limitation for the navigation profile
+// (/detector/navigationProfile). e+/e- msc keeps the cheaper UseSafety
+// everywhere except the thin gas gaps of GapRegion, where an Urban model with
+// UseDistanceToBoundary is configured below 100 MeV. Does nothing when the
+// detector did not create GapRegion.
+class ALPGunMscRegionPhysics : public G4VPhysicsConstructor
+{
+  public:
+    ALPGunMscRegionPhysics();
+    virtual ~ALPGunMscRegionPhysics();
+
+    virtual void ConstructParticle();
+    virtual void ConstructProcess();
+};
+
+#endif
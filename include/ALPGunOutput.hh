@@ -0,0 +1,68 @@
+#ifndef ALPGunOutput_h
+#define ALPGunOutput_h 1
+
+#include "ALPGunRow.hh"
+#include "G4GenericMessenger.hh"
+#include "globals.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Destination of the DAMSA rows, shared by the master and all workers.
+//
+// The default "root" backend fills ntuple 0 of the thread-local
+// G4RootAnalysisManager. The "stream" backend collects rows in per-thread
+// batches and hands them to a single writer thread, which streams them to a
+// named pipe or, with a "unix:" prefix, to a local socket while the run is in
+// progress. The queue between workers and the writer is bounded, so a slow
+// reader throttles the simulation instead of growing memory.
+//
+// Stream layout (host byte order):
+//   header : "ALPGSTRM", uint32 version, uint32 nColumns,
+//            per column: uint8 type (1 = float64), uint16 name length, name
+//   batch  : "BTCH", uint32 nRows, nColumns blocks of nRows values
+//   trailer: "END\0", uint64 total number of rows
+class ALPGunOutput
+{
+  public:
+    static ALPGunOutput* Instance();
+
+    // Called from every BeginOfRunAction/EndOfRunAction, the stream is opened
+    // by the first caller and closed by the last one
+    void Open();
+    void Close();
+
+    void Fill(const ALPGunRow& row);
+
+    G4bool IsStreaming() const { return fBackend == "stream"; }
+
+  private:
+    ALPGunOutput();
+    ~ALPGunOutput();
+
+    void FlushBatch(std::vector<G4double>& batch);
+    void WriteLoop();
+    G4bool WriteBytes(const void* data, std::size_t size);
+
+    G4GenericMessenger* messenger;
+    G4String fBackend;
+    G4String fStreamPath;
+    G4int fBatchSize;
+    G4int fMaxQueued;
+
+    std::mutex fMutex;
+    std::condition_variable fNotEmpty;
+    std::condition_variable fNotFull;
+    std::deque<std::vector<G4double>> fQueue;
+    std::thread fWriter;
+    G4int fUsers;
+    G4int fFd;
+    G4bool fStopping;
+    G4bool fBroken;
+    unsigned long long fTotalRows;
+};
+
+#endif
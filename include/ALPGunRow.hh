@@ -0,0 +1,15 @@
+#ifndef ALPGunRow_h
+#define ALPGunRow_h 1
+
+#include "globals.hh"
+
+// One row of the DAMSA table, in the column order of ALPGunRow::ColumnNames()
+struct ALPGunRow
+{
+  static const G4int nColumns = 13;
+  static const char* const* ColumnNames();
+
+  G4double values[nColumns];
+};
+
+#endif
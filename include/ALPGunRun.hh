@@ -11,6 +11,20 @@ class ALPGunRun : public G4Run
   public:
     ALPGunRun();
     virtual ~ALPGunRun();
+
+    virtual void Merge(const G4Run*);
+
+    void CountTrigger(G4bool accepted) { ++(accepted ? fAccepted : fRejected); }
+    G4int GetNumberOfAccepted() const { return fAccepted; }
+    G4int GetNumberOfRejected() const { return fRejected; }
+
+    void AddSteps(G4int n) { fSteps += n; }
+    G4double GetNumberOfSteps() const { return fSteps; }
+
+  private:
+    G4int fAccepted;
+    G4int fRejected;
+    G4double fSteps;
 };
 
 #endif
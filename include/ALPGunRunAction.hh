@@ -2,6 +2,8 @@
 #define ALPGunRunAction_h 1
 
 #include "G4UserRunAction.hh"
+#include "G4Timer.hh"
+#include "G4GenericMessenger.hh"
 #include "globals.hh"
 #include "ALPGunDetectorConstruction.hh"
 class G4Run;
@@ -15,6 +17,26 @@ class ALPGunRunAction : public G4UserRunAction
     virtual G4Run* GenerateRun();
     virtual void BeginOfRunAction(const G4Run*);
     virtual void EndOfRunAction(const G4Run*);
+
+    // Layers 0-5 of the stack get their own columns in the Summary ntuple
+    static const G4int nSummaryLayers = 6;
+
+    G4bool IsDigitizationEnabled() const { return fDigitize; }
+
+    // -1 when the ntuple is not booked for this run
+    G4int GetDigiNtupleId() const { return fDigiNtupleId; }
+    G4int GetSummaryNtupleId() const { return fSummaryNtupleId; }
+
+  private:
+    // Here rather than in the event action and the digitizer so that the
+    // master, which has neither, books the same ntuples as the workers
+    G4GenericMessenger* digiMessenger;
+    G4GenericMessenger* summaryMessenger;
+    G4bool fDigitize;
+    G4bool fWriteSummary;
+    G4int fDigiNtupleId;
+    G4int fSummaryNtupleId;
+    G4Timer fTimer;
 };
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef ALPGunScoreWriter_h
+#define ALPGunScoreWriter_h 1
+
+#include "G4VScoreWriter.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+
+// Writes command-based scoring meshes (/score/...) as binary grids instead of
+// CSV text. The meshes are filled thread-locally and merged into the master
+// by Geant4 at end of run; /score/dumpQuantityToFile and
+// /score/dumpAllQuantitiesToFile then end up here.
+//
+// Every quantity is one block (host byte order):
+//   "ALPGMESH", uint32 version, uint8 shape (0 box, 1 cylinder),
+//   uint32 nBins[3], float64 size[3] [mm], float64 translation[3] [mm],
+//   uint16 length + mesh name, uint16 length + quantity name,
+//   uint16 length + unit, then nBins[0]*nBins[1]*nBins[2] float32 values
+//   in the unit, with the last bin index running fastest.
+// nBins and the grid axes follow G4VScoringMesh::GetNumberOfSegments():
+// x, y, z for a box, but z, phi, r for a cylinder (not the r, z, phi order of
+// /score/mesh/nBin). size is the half-widths x, y, z for a box and
+// rMin, rMax, half-length for a cylinder.
+// dumpAllQuantitiesToFile writes the blocks of all quantities back to back.
+class ALPGunScoreWriter : public G4VScoreWriter
+{
+  public:
+    ALPGunScoreWriter();
+    virtual ~ALPGunScoreWriter();
+
+    virtual void DumpQuantityToFile(const G4String& psName, const G4String& fileName, const G4String& option);
+    virtual void DumpAllQuantitiesToFile(const G4String& fileName, const G4String& option);
+
+  private:
+    G4bool WriteQuantity(std::ostream& out, const G4String& psName);
+};
+
+#endif
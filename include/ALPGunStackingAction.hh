@@ -0,0 +1,37 @@
+#ifndef ALPGunStackingAction_h
+#define ALPGunStackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "G4GenericMessenger.hh"
+#include "globals.hh"
+
+class ALPGunEventAction;
+
+// Hands energetic secondaries of a large event to the sub-event stack so that
+// other worker threads can transport them (Geant4 >= 11.3 with
+// G4RUN_MANAGER_TYPE=SubEvt). A secondary is offloaded when it is above
+// /subEvent/minEnergy or when the urgent stack of this thread already holds
+// more than /subEvent/stackDepth tracks; a threshold of 0 disables that test.
+//
+// Results of sub-events are not merged back into their parent event, so
+// nothing is offloaded while a feature needs complete events (see
+// ALPGunEventAction::NeedsCompleteEvents()). Only the DAMSA rows, written as
+// the tracks are transported, and the step count cover offloaded tracks.
+class ALPGunStackingAction : public G4UserStackingAction
+{
+  public:
+    ALPGunStackingAction(const ALPGunEventAction* eventAction);
+    virtual ~ALPGunStackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+    virtual void PrepareNewEvent();
+
+  private:
+    const ALPGunEventAction* fEventAction;
+    G4GenericMessenger* messenger;
+    G4bool fOffload;
+    G4double fMinEnergy;
+    G4int fStackDepth;
+};
+
+#endif
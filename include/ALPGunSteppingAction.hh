@@ -5,16 +5,21 @@
 #include "globals.hh"
 
 class G4LogicalVolume;
+class G4Track;
+class ALPGunEventAction;
 
 class ALPGunSteppingAction : public G4UserSteppingAction
 {
   public:
-    ALPGunSteppingAction();
+    ALPGunSteppingAction(ALPGunEventAction* eventAction);
     virtual ~ALPGunSteppingAction();
 
     virtual void UserSteppingAction(const G4Step*);
 
   private:
+    void FillRow(const G4Track* tr, G4double edep) const;
+
+    ALPGunEventAction* fEventAction;
     G4LogicalVolume* fScoringVolume1;
     G4LogicalVolume* fScoringVolume2;
     G4LogicalVolume* fScoringVolume3;
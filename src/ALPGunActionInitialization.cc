@@ -1,7 +1,9 @@
 #include "ALPGunActionInitialization.hh"
 #include "ALPGunPrimaryGeneratorAction.hh"
 #include "ALPGunRunAction.hh"
+#include "ALPGunEventAction.hh"
 #include "ALPGunSteppingAction.hh"
+#include "ALPGunStackingAction.hh"
 
 ALPGunActionInitialization::ALPGunActionInitialization()
 {}
@@ -17,7 +19,11 @@ void ALPGunActionInitialization::BuildForMaster() const
 void ALPGunActionInitialization::Build() const
 {
   SetUserAction(new ALPGunPrimaryGeneratorAction);
-  SetUserAction(new ALPGunRunAction);
-  SetUserAction(new ALPGunSteppingAction);
+  ALPGunRunAction* runAction = new ALPGunRunAction;
+  SetUserAction(runAction);
+  ALPGunEventAction* eventAction = new ALPGunEventAction(runAction);
+  SetUserAction(eventAction);
+  SetUserAction(new ALPGunSteppingAction(eventAction));
+  SetUserAction(new ALPGunStackingAction(eventAction));
 }  
 
@@ -0,0 +1,156 @@
+#include "ALPGunConvergence.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <cfloat>
+#include <cmath>
+
+ALPGunConvergence* ALPGunConvergence::Instance()
+{
+  // Never deleted: the messenger must not outlive the UI manager at exit
+  static ALPGunConvergence* instance = new ALPGunConvergence;
+  return instance;
+}
+
+ALPGunConvergence::ALPGunConvergence()
+: fEnabled(false),
+  fTarget("gapMean"),
+  fPrecision(0.01),
+  fLayer(-1),
+  fMinEvents(100),
+  fMaxEvents(0),
+  fNEvents(0),
+  fN(0),
+  fMean(0.), fM2(0.), fM3(0.), fM4(0.),
+  fConverged(false)
+{
+  // Shared between threads, so the commands are applied once on the master
+  messenger = new G4GenericMessenger(this, "/adaptive/", "Precision-targeted run termination");
+  messenger->DeclareProperty("enable", fEnabled)
+        .SetGuidance("Stop the run once the target precision is reached")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("target", fTarget)
+        .SetGuidance("Set target quantity: gapMean, gapRMS or samplingFraction")
+        .SetCandidates("gapMean gapRMS samplingFraction")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("precision", fPrecision)
+        .SetGuidance("Set relative precision goal of the target")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("layer", fLayer)
+        .SetGuidance("Restrict the target to one layer, -1 for the whole stack")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("minEvents", fMinEvents)
+        .SetGuidance("Set number of events before convergence is tested")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("maxEvents", fMaxEvents)
+        .SetGuidance("Set hard cap on the number of events, 0 for the /run/beamOn count")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+}
+
+ALPGunConvergence::~ALPGunConvergence()
+{
+  delete messenger;
+}
+
+void ALPGunConvergence::BeginRun()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fNEvents = fN = 0;
+  fMean = fM2 = fM3 = fM4 = 0.;
+  fConverged = false;
+}
+
+G4bool ALPGunConvergence::AddEvent(G4double gapEnergy, G4double absorberEnergy)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  // Events other workers finish after convergence still count
+  ++fNEvents;
+  if (fConverged) return true;
+
+  G4double x = gapEnergy;
+  if (fTarget == "samplingFraction") {
+    // No deposit in the stack, only counts toward maxEvents
+    if (gapEnergy + absorberEnergy <= 0.) {
+      fConverged = Done();
+      return fConverged;
+    }
+    x = gapEnergy / (gapEnergy + absorberEnergy);
+  }
+
+  // One-pass update of the central moments up to fourth order
+  G4int n1 = fN++;
+  G4double n = fN;
+  G4double delta = x - fMean;
+  G4double dn = delta / n;
+  G4double dn2 = dn * dn;
+  G4double term1 = delta * dn * n1;
+  fMean += dn;
+  fM4 += term1 * dn2 * (n * n - 3. * n + 3.) + 6. * dn2 * fM2 - 4. * dn * fM3;
+  fM3 += term1 * dn * (n - 2.) - 3. * dn * fM2;
+  fM2 += term1;
+
+  fConverged = Done();
+  return fConverged;
+}
+
+G4double ALPGunConvergence::Value() const
+{
+  if (fTarget == "gapRMS") return fN > 1 ? std::sqrt(fM2 / (fN - 1)) : 0.;
+  return fMean;
+}
+
+G4double ALPGunConvergence::RelativeError() const
+{
+  if (fN < 2 || fM2 <= 0.) return DBL_MAX;
+  G4double var = fM2 / (fN - 1);
+
+  if (fTarget == "gapRMS") {
+    // Variance of the sample variance from the fourth central moment
+    G4double m2 = fM2 / fN;
+    G4double m4 = fM4 / fN;
+    G4double varOfVar = (m4 - m2 * m2 * (fN - 3.) / (fN - 1.)) / fN;
+    return varOfVar > 0. ? 0.5 * std::sqrt(varOfVar) / var : 0.;
+  }
+
+  if (fMean == 0.) return DBL_MAX;
+  return std::sqrt(var / fN) / std::abs(fMean);
+}
+
+G4bool ALPGunConvergence::Done() const
+{
+  if (fMaxEvents > 0 && fNEvents >= fMaxEvents) return true;
+  return fN >= fMinEvents && RelativeError() <= fPrecision;
+}
+
+void ALPGunConvergence::Report() const
+{
+  if (!fEnabled) return;
+
+  std::lock_guard<std::mutex> lock(fMutex);
+  G4double unit = fTarget == "samplingFraction" ? 1. : MeV;
+  G4double relErr = RelativeError();
+  G4cout << "--------------------Adaptive run--------------------" << G4endl
+         << " Target " << fTarget;
+  if (fLayer >= 0) G4cout << " (layer " << fLayer << ")";
+  G4cout << " = " << Value() / unit;
+  if (unit != 1.) G4cout << " MeV";
+  G4cout << " after " << fNEvents << " events";
+  if (fN != fNEvents) G4cout << " (" << fN << " with a deposit)";
+  G4cout << G4endl
+         << " Relative precision " << (relErr < DBL_MAX ? relErr : -1.)
+         << " (goal " << fPrecision << ") "
+         << (fN >= fMinEvents && relErr <= fPrecision ? "reached" : "not reached") << G4endl
+         << "----------------------------------------------------" << G4endl;
+}
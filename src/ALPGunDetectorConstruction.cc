@@ -9,9 +9,37 @@
 #include "G4Sphere.hh"
 #include "G4Trd.hh"
 #include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4PhysicalVolumeStore.hh"
 #include "G4PVPlacement.hh"
+#include "G4SDManager.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#ifdef G4LIB_USE_GDML
+#include "G4GDMLParser.hh"
+#endif
 #include "G4SystemOfUnits.hh"
+#include "G4UImanager.hh"
+#include "G4Version.hh"
 #include "ALPGunRunAction.hh"
+#include "ALPGunGapSD.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+// Set by CMake from the detector construction sources; other builds fall back
+// to the build time, so every rebuild invalidates the cache
+#ifndef ALPGUN_GEOMETRY_HASH
+#define ALPGUN_GEOMETRY_HASH __DATE__ " " __TIME__
+#endif
+
 ALPGunDetectorConstruction::ALPGunDetectorConstruction()
 : G4VUserDetectorConstruction(),
   fScoringVolume1(0),
@@ -20,7 +48,12 @@ ALPGunDetectorConstruction::ALPGunDetectorConstruction()
   fScoringVolume4(0),
   fScoringVolume5(0),
   detectorLength(0.),
-  targetLength(0.)
+  targetLength(0.),
+  fCheckOverlaps(true),
+  fUseCache(false),
+  fRevalidate(false),
+  fCacheDir("geometryCache"),
+  fNavigationProfile(false)
 {
   messenger = new G4GenericMessenger(this, "/detector/", "Detector properties");
   messenger->DeclarePropertyWithUnit("absorberLength","cm", m_absorberLength)
@@ -42,6 +75,22 @@ ALPGunDetectorConstruction::ALPGunDetectorConstruction()
   messenger->DeclarePropertyWithUnit("targetLength","cm", m_targetLength)
         .SetGuidance("Set target length")
         .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclareProperty("navigationProfile", fNavigationProfile)
+        .SetGuidance("Put the stack in an envelope with tuned voxels and per-region msc step limits")
+        .SetStates(G4State_PreInit);
+
+  messenger->DeclareProperty("useGeometryCache", fUseCache)
+        .SetGuidance("Load the geometry from the GDML cache when the parameters match")
+        .SetStates(G4State_PreInit);
+
+  messenger->DeclareProperty("geometryCacheDir", fCacheDir)
+        .SetGuidance("Set directory of the geometry cache")
+        .SetStates(G4State_PreInit);
+
+  messenger->DeclareProperty("revalidateGeometry", fRevalidate)
+        .SetGuidance("Rebuild, check overlaps and rewrite the cached geometry")
+        .SetStates(G4State_PreInit);
 }
 
 ALPGunDetectorConstruction::~ALPGunDetectorConstruction()
@@ -50,6 +99,121 @@ ALPGunDetectorConstruction::~ALPGunDetectorConstruction()
 }
 
 G4VPhysicalVolume* ALPGunDetectorConstruction::Construct()
+{
+  G4VPhysicalVolume* physWorld = fUseCache ? ConstructCached() : ConstructGeometry();
+  if (fNavigationProfile) ConfigureNavigation();
+
+  // World (and Wall) half-length and the target extent in mm for macros,
+  // e.g. {worldHalfZ} and {targetZ} in scoring.mac
+  G4UImanager* uiManager = G4UImanager::GetUIpointer();
+  const G4Box* worldBox = static_cast<const G4Box*>(physWorld->GetLogicalVolume()->GetSolid());
+  std::ostringstream alias;
+  alias << "worldHalfZ " << worldBox->GetZHalfLength() / mm;
+  uiManager->SetAlias(alias.str().c_str());
+
+  const G4VPhysicalVolume* phyTarget = G4PhysicalVolumeStore::GetInstance()->GetVolume("Target");
+  const G4Box* targetBox = static_cast<const G4Box*>(phyTarget->GetLogicalVolume()->GetSolid());
+  alias.str("");
+  alias << "targetHalfZ " << targetBox->GetZHalfLength() / mm;
+  uiManager->SetAlias(alias.str().c_str());
+  alias.str("");
+  alias << "targetZ " << phyTarget->GetTranslation().z() / mm;
+  uiManager->SetAlias(alias.str().c_str());
+  return physWorld;
+}
+
+G4VPhysicalVolume* ALPGunDetectorConstruction::ConstructCached()
+{
+#ifdef G4LIB_USE_GDML
+  // Everything the geometry depends on: the parameters, the source that
+  // builds it and the Geant4 release that writes and reads the GDML
+  std::ostringstream params;
+  params << "source " << ALPGUN_GEOMETRY_HASH << "\n"
+         << "geant4 " << G4VERSION_NUMBER << "\n"
+         << "absorberLength " << m_absorberLength / mm << "\n"
+         << "gapLength " << m_gapLength / mm << "\n"
+         << "numLayers " << m_numLayers << "\n"
+         << "absorberMaterial " << m_absorber_mat << "\n"
+         << "targetLength " << m_targetLength / mm << "\n"
+         << "navigationProfile " << fNavigationProfile << "\n";
+
+  // FNV-1a, stable across compilers unlike std::hash
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (char c : params.str()) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+  std::filesystem::path dir(fCacheDir.c_str());
+  std::filesystem::path gdmlFile = dir / (key.str() + ".gdml");
+  std::filesystem::path manifestFile = dir / (key.str() + ".manifest");
+
+  std::ostringstream manifest;
+  manifest << params.str() << "overlapsChecked 1\n";
+
+  G4bool cached = false;
+  if (!fRevalidate && std::filesystem::exists(gdmlFile)) {
+    std::ifstream in(manifestFile);
+    std::stringstream stored;
+    stored << in.rdbuf();
+    cached = stored.str() == manifest.str();
+  }
+
+  if (cached) {
+    G4cout << "Loading cached geometry " << gdmlFile.string() << G4endl;
+    G4GDMLParser parser;
+    parser.Read(gdmlFile.string(), false);
+    G4VPhysicalVolume* physWorld = parser.GetWorldVolume();
+
+    // Entries are only ever published complete (see below); a malformed file
+    // is a fatal error in G4GDMLParser, there is no fallback to a rebuild
+    targetLength = m_targetLength;
+    detectorLength = m_numLayers * (m_absorberLength + m_gapLength);
+    G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+    fScoringVolume1 = store->GetVolume("World");
+    fScoringVolume2 = store->GetVolume("Target");
+    fScoringVolume3 = store->GetVolume("Vac");
+    return physWorld;
+  }
+
+  // Validate overlaps once, then export for the following jobs
+  fCheckOverlaps = true;
+  G4VPhysicalVolume* physWorld = ConstructGeometry();
+
+  // Jobs sharing the cache may miss at the same time: each one writes under
+  // its own name and renames into place, manifest last, so readers only ever
+  // see complete files
+  std::ostringstream tmpKey;
+  tmpKey << key.str() << ".tmp" << std::hex << std::random_device()();
+  std::filesystem::path gdmlTmp = dir / (tmpKey.str() + ".gdml");
+  std::filesystem::path manifestTmp = dir / (tmpKey.str() + ".manifest");
+
+  std::error_code error;
+  std::filesystem::create_directories(dir, error);
+  G4GDMLParser parser;
+  parser.Write(gdmlTmp.string(), physWorld);
+  std::ofstream(manifestTmp) << manifest.str();
+  std::filesystem::rename(gdmlTmp, gdmlFile, error);
+  if (!error) std::filesystem::rename(manifestTmp, manifestFile, error);
+  if (error) {
+    G4Exception("ALPGunDetectorConstruction::Construct()", "ALPGunGeom003", JustWarning,
+                ("Cannot store geometry in " + dir.string() + ": " + error.message()).c_str());
+    std::filesystem::remove(gdmlTmp, error);
+    std::filesystem::remove(manifestTmp, error);
+    return physWorld;
+  }
+  G4cout << "Geometry cached as " << gdmlFile.string() << G4endl;
+  return physWorld;
+#else
+  G4Exception("ALPGunDetectorConstruction::Construct()", "ALPGunGeom001", JustWarning,
+              "Geometry cache needs Geant4 with GDML support, building the geometry");
+  return ConstructGeometry();
+#endif
+}
+
+G4VPhysicalVolume* ALPGunDetectorConstruction::ConstructGeometry()
 {  
 
     // === Parameters ===
@@ -98,7 +262,7 @@ G4Material* pcb_mat = FR4;
                                                      0,
                                                      false,
                                                      0,
-                                                     true);
+                                                     fCheckOverlaps);
 
     G4Tubs* solidWall =
       new G4Tubs("Wall",                    //its name
@@ -117,7 +281,7 @@ G4Material* pcb_mat = FR4;
                     logicWorld,              //its mother  volume
                     false,                   //no boolean operation
                     0,                       //copy number
-                    true);          //overlaps checking
+                    fCheckOverlaps);          //overlaps checking
     
   
     G4Box* solidTarget =
@@ -137,7 +301,7 @@ G4Material* pcb_mat = FR4;
                       logicWorld,              //its mother  volume
                       false,                   //no boolean operation
                       0,                       //copy number
-                      true);          //overlaps checking
+                      fCheckOverlaps);          //overlaps checking
   
   
     G4Tubs* solidVacCha =
@@ -155,7 +319,7 @@ G4Material* pcb_mat = FR4;
                       logicWorld,              //its mother  volume
                       false,                   //no boolean operation
                       0,                       //copy number
-                      true);          //overlaps checking
+                      fCheckOverlaps);          //overlaps checking
   
   
     G4Tubs* solidVac =
@@ -175,7 +339,7 @@ G4Material* pcb_mat = FR4;
                       logicWorld,              //its mother  volume
                       false,                   //no boolean operation
                       0,                       //copy number
-                      true);          //overlaps checking
+                      fCheckOverlaps);          //overlaps checking
   
   G4double currentZ = 0.0 * cm; 
 
@@ -186,6 +350,23 @@ G4double commonGapThick = 0.3 * cm; // 3mm
 G4double cuThick  = 0.1 * cm;       // 1mm
 G4double pcbThick = 0.3 * cm;       // 3mm
 G4double normalAbsThick = 1.0 * cm;
+G4double backAbsThick = 24.0 * cm;
+G4double stackLength = firstAbsThick + firstGapThick + cuThick + pcbThick
+                     + 5 * (normalAbsThick + pcbThick + commonGapThick + cuThick + pcbThick)
+                     + backAbsThick;
+
+// Navigation profile: the stack goes into a tight air envelope so the World
+// only voxelizes a handful of daughters (see ConfigureNavigation()). It spans
+// exactly z = 0 to stackLength: Vac ends at z = 0 and the first and last
+// absorbers may touch its faces.
+G4LogicalVolume* logicStack = logicWorld;
+G4double stackShift = 0.;
+if (fNavigationProfile) {
+    G4Box* sCalo = new G4Box("Calorimeter", 6*cm, 6*cm, stackLength/2);
+    logicStack = new G4LogicalVolume(sCalo, world_mat, "Calorimeter");
+    new G4PVPlacement(0, G4ThreeVector(0, 0, stackLength/2), logicStack, "Calorimeter", logicWorld, false, 0, fCheckOverlaps);
+    stackShift = -stackLength/2;
+}
 
 for (G4int i = 0; i < 6; ++i) { // 총 6개 레이어 (0번 + 반복 5번)
     
@@ -195,28 +376,28 @@ for (G4int i = 0; i < 6; ++i) { // 총 6개 레이어 (0번 + 반복 5번)
         currentZ += firstAbsThick / 2.0;
         G4Box* sAbs = new G4Box("Absorber", 6*cm, 6*cm, firstAbsThick/2);
         G4LogicalVolume* lAbs = new G4LogicalVolume(sAbs, absorber_mat, "Absorber");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lAbs, "Absorber", logicWorld, false, i, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lAbs, "Absorber", logicStack, false, i, fCheckOverlaps);
         currentZ += firstAbsThick / 2.0;
 
         // 2. Gap (3mm)
         currentZ += firstGapThick / 2.0;
         G4Box* sGap = new G4Box("Gap", detectorWidth/2, detectorWidth/2, firstGapThick/2);
         G4LogicalVolume* lGap = new G4LogicalVolume(sGap, gap_mat, "Gap");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lGap, "Gap", logicWorld, false, i + 100, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lGap, "Gap", logicStack, false, i + 100, fCheckOverlaps);
         currentZ += firstGapThick / 2.0;
 
         // 3. Cu (1mm)
         currentZ += cuThick / 2.0;
         G4Box* sCu = new G4Box("Cu", detectorWidth/2, detectorWidth/2, cuThick/2);
         G4LogicalVolume* lCu = new G4LogicalVolume(sCu, cu_mat, "Cu"); // cu_mat 정의 필요
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lCu, "Cu", logicWorld, false, i + 300, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lCu, "Cu", logicStack, false, i + 300, fCheckOverlaps);
         currentZ += cuThick / 2.0;
 
         // 4. PCB (3mm)
         currentZ += pcbThick / 2.0;
         G4Box* sPCB = new G4Box("PCB", detectorWidth/2, detectorWidth/2, pcbThick/2);
         G4LogicalVolume* lPCB = new G4LogicalVolume(sPCB, pcb_mat, "PCB");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lPCB, "PCB", logicWorld, false, i + 200, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lPCB, "PCB", logicStack, false, i + 200, fCheckOverlaps);
         currentZ += pcbThick / 2.0;
 
     } else {
@@ -226,43 +407,43 @@ for (G4int i = 0; i < 6; ++i) { // 총 6개 레이어 (0번 + 반복 5번)
         currentZ += normalAbsThick / 2.0;
         G4Box* sAbs = new G4Box("Absorber", detectorWidth/2, detectorWidth/2, normalAbsThick/2);
         G4LogicalVolume* lAbs = new G4LogicalVolume(sAbs, absorber_mat, "Absorber");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lAbs, "Absorber", logicWorld, false, i, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lAbs, "Absorber", logicStack, false, i, fCheckOverlaps);
         currentZ += normalAbsThick / 2.0;
 
         // 2. PCB (3mm) - Absorber 뒤에 붙는 첫 번째 PCB
         currentZ += pcbThick / 2.0;
         G4Box* sPCB1 = new G4Box("PCB", detectorWidth/2, detectorWidth/2, pcbThick/2);
         G4LogicalVolume* lPCB1 = new G4LogicalVolume(sPCB1, pcb_mat, "PCB");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lPCB1, "PCB", logicWorld, false, i + 200, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lPCB1, "PCB", logicStack, false, i + 200, fCheckOverlaps);
         currentZ += pcbThick / 2.0;
 
         // 3. Gap (3mm)
         currentZ += commonGapThick / 2.0;
         G4Box* sGap = new G4Box("Gap", detectorWidth/2, detectorWidth/2, commonGapThick/2);
         G4LogicalVolume* lGap = new G4LogicalVolume(sGap, gap_mat, "Gap");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lGap, "Gap", logicWorld, false, i + 100, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lGap, "Gap", logicStack, false, i + 100, fCheckOverlaps);
         currentZ += commonGapThick / 2.0;
 
         // 4. Cu (1mm)
         currentZ += cuThick / 2.0;
         G4Box* sCu = new G4Box("Cu", detectorWidth/2, detectorWidth/2, cuThick/2);
         G4LogicalVolume* lCu = new G4LogicalVolume(sCu, cu_mat, "Cu");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lCu, "Cu", logicWorld, false, i + 300, true);
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lCu, "Cu", logicStack, false, i + 300, fCheckOverlaps);
         currentZ += cuThick / 2.0;
 
         // 5. PCB (3mm) - Cu 뒤에 붙는 두 번째 PCB
         currentZ += pcbThick / 2.0;
         G4Box* sPCB2 = new G4Box("PCB", detectorWidth/2, detectorWidth/2, pcbThick/2);
         G4LogicalVolume* lPCB2 = new G4LogicalVolume(sPCB2, pcb_mat, "PCB");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lPCB2, "PCB", logicWorld, false, i + 400, true); // CopyNo 주의
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lPCB2, "PCB", logicStack, false, i + 400, fCheckOverlaps); // CopyNo 주의
         currentZ += pcbThick / 2.0;
     }
 }
-        currentZ += 24*cm / 2.0;
-        G4Box* sAbs = new G4Box("Absorber", 6*cm, 6*cm, 24*cm/2);
+        currentZ += backAbsThick / 2.0;
+        G4Box* sAbs = new G4Box("Absorber", 6*cm, 6*cm, backAbsThick/2);
         G4LogicalVolume* lAbs = new G4LogicalVolume(sAbs, absorber_mat, "Absorber");
-        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ), lAbs, "Absorber", logicWorld, false, 11, true);
-        currentZ += 24*cm / 2.0;
+        new G4PVPlacement(0, G4ThreeVector(0, 0, currentZ + stackShift), lAbs, "Absorber", logicStack, false, 11, fCheckOverlaps);
+        currentZ += backAbsThick / 2.0;
 
   
     fScoringVolume1 = logicWorld;
@@ -272,3 +453,38 @@ for (G4int i = 0; i < 6; ++i) { // 총 6개 레이어 (0번 + 반복 5번)
     return physWorld;
 }
 
+void ALPGunDetectorConstruction::ConfigureNavigation()
+{
+  G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+
+  // Slice the envelope finely enough along z that a voxel rarely holds more
+  // than one slab, the thinnest (Cu) being 1 mm
+  G4LogicalVolume* logicCalo = store->GetVolume("Calorimeter", false);
+  if (logicCalo && logicCalo->GetNoDaughters() > 0) {
+    G4double caloLength = 2 * static_cast<G4Box*>(logicCalo->GetSolid())->GetZHalfLength();
+    G4double smartless = caloLength / (1*mm * logicCalo->GetNoDaughters());
+    logicCalo->SetSmartless(std::max(2., smartless));
+  }
+
+  // Regions for per-region msc step limitation, see ALPGunMscRegionPhysics
+  G4ProductionCuts* cuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+  G4Region* absorberRegion = G4RegionStore::GetInstance()->FindOrCreateRegion("AbsorberRegion");
+  G4Region* gapRegion = G4RegionStore::GetInstance()->FindOrCreateRegion("GapRegion");
+  absorberRegion->SetProductionCuts(cuts);
+  gapRegion->SetProductionCuts(cuts);
+  for (G4LogicalVolume* lv : *store) {
+    if (lv->GetName() == "Absorber") absorberRegion->AddRootLogicalVolume(lv);
+    else if (lv->GetName() == "Gap") gapRegion->AddRootLogicalVolume(lv);
+  }
+}
+
+void ALPGunDetectorConstruction::ConstructSDandField()
+{
+  // Every Gap layer has its own logical volume, attach the readout to all of them
+  ALPGunGapSD* gapSD = new ALPGunGapSD("GapSD", "GapHitsCollection");
+  G4SDManager::GetSDMpointer()->AddNewDetector(gapSD);
+
+  for (G4LogicalVolume* lv : *G4LogicalVolumeStore::GetInstance()) {
+    if (lv->GetName() == "Gap") SetSensitiveDetector(lv, gapSD);
+  }
+}
@@ -0,0 +1,135 @@
+#include "ALPGunEventAction.hh"
+#include "ALPGunGapDigitizer.hh"
+#include "ALPGunGapDigi.hh"
+#include "ALPGunConvergence.hh"
+#include "ALPGunRunAction.hh"
+#include "ALPGunRun.hh"
+#include "ALPGunOutput.hh"
+
+#include "G4RootAnalysisManager.hh"
+#include "G4DigiManager.hh"
+#include "G4RunManager.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4SystemOfUnits.hh"
+
+ALPGunEventAction::ALPGunEventAction(const ALPGunRunAction* runAction)
+: G4UserEventAction(),
+  fRunAction(runAction),
+  fDigitizer(0),
+  fDCID(-1),
+  fInfo(0)
+{
+  // G4DigiManager is thread-local and takes ownership of the module
+  fDigitizer = new ALPGunGapDigitizer("GapDigitizer");
+  G4DigiManager::GetDMpointer()->AddNewModule(fDigitizer);
+}
+
+ALPGunEventAction::~ALPGunEventAction()
+{}
+
+G4bool ALPGunEventAction::IsDigitizing() const
+{
+  return fRunAction->IsDigitizationEnabled();
+}
+
+G4bool ALPGunEventAction::NeedsCompleteEvents() const
+{
+  return fTrigger.IsEnabled() || fRunAction->IsDigitizationEnabled()
+      || fRunAction->GetSummaryNtupleId() >= 0 || ALPGunConvergence::Instance()->IsEnabled();
+}
+
+void ALPGunEventAction::BeginOfEventAction(const G4Event*)
+{
+  // Owned by the event
+  fInfo = new ALPGunEventInfo;
+  G4EventManager::GetEventManager()->SetUserInformation(fInfo);
+}
+
+void ALPGunEventAction::EndOfEventAction(const G4Event* event)
+{
+  auto info = static_cast<const ALPGunEventInfo*>(event->GetUserInformation());
+  auto run = static_cast<ALPGunRun*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  run->AddSteps(info->GetNumberOfSteps());
+
+  // Partial sums of an offloaded part of an event, only its steps count
+  if (IsSubEvent(event)) return;
+
+  G4bool accepted = true;
+  if (fTrigger.IsEnabled()) {
+    accepted = fTrigger.Accept(*info);
+    run->CountTrigger(accepted);
+  }
+  if (accepted) {
+    for (const ALPGunRow& row : info->GetRows()) ALPGunOutput::Instance()->Fill(row);
+  }
+
+  if (accepted && fRunAction->GetDigiNtupleId() >= 0) WriteDigis(event);
+  if (fRunAction->GetSummaryNtupleId() >= 0) WriteSummary(event);
+
+  ALPGunConvergence* convergence = ALPGunConvergence::Instance();
+  if (convergence->IsEnabled()) {
+    G4int layer = convergence->GetLayer();
+    if (convergence->AddEvent(info->GetGapEdep(layer), info->GetAbsorberEdep(layer))) {
+      // Soft abort: the current event is finished, no new one is started
+      G4RunManager::GetRunManager()->AbortRun(true);
+    }
+  }
+}
+
+G4bool ALPGunEventAction::IsSubEvent(const G4Event* event)
+{
+#if G4VERSION_NUMBER >= 1130
+  return event->GetMotherEvent() != nullptr;
+#else
+  (void)event;
+  return false;
+#endif
+}
+
+void ALPGunEventAction::WriteDigis(const G4Event* event)
+{
+  G4DigiManager* digiManager = G4DigiManager::GetDMpointer();
+  digiManager->Digitize("GapDigitizer");
+  if (fDCID < 0) fDCID = digiManager->GetDigiCollectionID("GapDigitizer/GapDigiCollection");
+  auto digis = static_cast<const ALPGunGapDigiCollection*>(digiManager->GetDigiCollection(fDCID));
+  if (!digis) return;
+
+  auto analysisManager = G4RootAnalysisManager::Instance();
+  G4int id = fRunAction->GetDigiNtupleId();
+  for (std::size_t i = 0; i < digis->entries(); ++i) {
+    const ALPGunGapDigi* digi = (*digis)[i];
+    analysisManager->FillNtupleIColumn(id, 0, event->GetEventID());
+    analysisManager->FillNtupleIColumn(id, 1, digi->GetLayer());
+    analysisManager->FillNtupleIColumn(id, 2, digi->GetPad());
+    analysisManager->FillNtupleFColumn(id, 3, digi->GetCharge());
+    analysisManager->FillNtupleFColumn(id, 4, digi->GetTime()/ns);
+    analysisManager->AddNtupleRow(id);
+  }
+}
+
+void ALPGunEventAction::WriteSummary(const G4Event* event)
+{
+  // Column order as booked in ALPGunRunAction::BeginOfRunAction()
+  auto info = static_cast<const ALPGunEventInfo*>(event->GetUserInformation());
+  auto analysisManager = G4RootAnalysisManager::Instance();
+  G4int id = fRunAction->GetSummaryNtupleId();
+  G4int col = 0;
+  analysisManager->FillNtupleIColumn(id, col++, event->GetEventID());
+  analysisManager->FillNtupleDColumn(id, col++, info->GetGapEdep(-1)/MeV);
+  analysisManager->FillNtupleDColumn(id, col++, info->GetAbsorberEdep(-1)/MeV);
+  for (G4int i = 0; i < ALPGunRunAction::nSummaryLayers; ++i) {
+    analysisManager->FillNtupleDColumn(id, col++, info->GetGapEdep(i)/MeV);
+  }
+  for (G4int i = 0; i < ALPGunRunAction::nSummaryLayers; ++i) {
+    analysisManager->FillNtupleDColumn(id, col++, info->GetAbsorberEdep(i)/MeV);
+  }
+  for (G4int i = 0; i < ALPGunEventInfo::nRadialBins; ++i) {
+    analysisManager->FillNtupleDColumn(id, col++, info->GetRadialEdep(i)/MeV);
+  }
+  for (G4int i = 0; i < ALPGunEventInfo::nSpecies; ++i) {
+    analysisManager->FillNtupleIColumn(id, col++, info->GetMultiplicity(i));
+  }
+  analysisManager->FillNtupleIColumn(id, col++, info->GetNumberOfSteps());
+  analysisManager->AddNtupleRow(id);
+}
@@ -0,0 +1,66 @@
+#include "ALPGunEventInfo.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+const G4double ALPGunEventInfo::radialBinWidth = 5. * mm;
+
+ALPGunEventInfo::ALPGunEventInfo()
+: G4VUserEventInformation(),
+  fNSteps(0)
+{
+  for (G4int i = 0; i < nRadialBins; ++i) fRadialEdep[i] = 0.;
+  for (G4int i = 0; i < nSpecies; ++i) fMultiplicity[i] = 0;
+}
+
+ALPGunEventInfo::~ALPGunEventInfo()
+{}
+
+void ALPGunEventInfo::Print() const
+{
+  G4cout << "Gap " << GetGapEdep(-1) / MeV << " MeV, Absorber "
+         << GetAbsorberEdep(-1) / MeV << " MeV" << G4endl;
+}
+
+G4int ALPGunEventInfo::GetNumberOfGapLayersHit() const
+{
+  G4int n = 0;
+  for (G4double edep : fGapEdep) {
+    if (edep > 0.) ++n;
+  }
+  return n;
+}
+
+void ALPGunEventInfo::AddRadialEdep(G4double r, G4double edep)
+{
+  G4int bin = (G4int)(r / radialBinWidth);
+  fRadialEdep[bin < nRadialBins ? bin : nRadialBins - 1] += edep;
+}
+
+void ALPGunEventInfo::CountTrack(G4int pdg)
+{
+  switch (pdg) {
+    case 22:   ++fMultiplicity[kGamma]; break;
+    case 11:   ++fMultiplicity[kElectron]; break;
+    case -11:  ++fMultiplicity[kPositron]; break;
+    case 2112: ++fMultiplicity[kNeutron]; break;
+    case 2212: ++fMultiplicity[kProton]; break;
+    default:   ++fMultiplicity[kOther]; break;
+  }
+}
+
+void ALPGunEventInfo::Add(std::vector<G4double>& perLayer, G4int layer, G4double edep)
+{
+  if (layer < 0) return;
+  if ((std::size_t)layer >= perLayer.size()) perLayer.resize(layer + 1, 0.);
+  perLayer[layer] += edep;
+}
+
+G4double ALPGunEventInfo::Sum(const std::vector<G4double>& perLayer, G4int layer)
+{
+  if (layer >= 0) return (std::size_t)layer < perLayer.size() ? perLayer[layer] : 0.;
+
+  G4double sum = 0.;
+  for (G4double edep : perLayer) sum += edep;
+  return sum;
+}
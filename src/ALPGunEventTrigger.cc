@@ -0,0 +1,46 @@
+#include "ALPGunEventTrigger.hh"
+#include "ALPGunEventInfo.hh"
+
+#include "G4SystemOfUnits.hh"
+
+ALPGunEventTrigger::ALPGunEventTrigger()
+: fEnabled(false),
+  fMinGapEnergy(0.),
+  fMinLayersHit(0),
+  fEntranceLayer(-1),
+  fMinEntranceEnergy(0.)
+{
+  messenger = new G4GenericMessenger(this, "/trigger/", "End-of-event trigger on the DAMSA rows");
+  messenger->DeclareProperty("enable", fEnabled)
+        .SetGuidance("Buffer rows per event and write only triggered events")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclarePropertyWithUnit("minGapEnergy", "MeV", fMinGapEnergy)
+        .SetGuidance("Set minimum summed Gap energy")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclareProperty("minLayersHit", fMinLayersHit)
+        .SetGuidance("Set minimum number of Gap layers with a deposit")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclareProperty("entranceLayer", fEntranceLayer)
+        .SetGuidance("Set layer whose Absorber entrance is tested, -1 to disable")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclarePropertyWithUnit("minEntranceEnergy", "MeV", fMinEntranceEnergy)
+        .SetGuidance("Set minimum kinetic energy entering the Absorber of entranceLayer")
+        .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+ALPGunEventTrigger::~ALPGunEventTrigger()
+{
+  delete messenger;
+}
+
+G4bool ALPGunEventTrigger::Accept(const ALPGunEventInfo& info) const
+{
+  if (info.GetGapEdep(-1) < fMinGapEnergy) return false;
+  if (info.GetNumberOfGapLayersHit() < fMinLayersHit) return false;
+  if (fEntranceLayer >= 0 && info.GetEntranceEnergy(fEntranceLayer) < fMinEntranceEnergy) return false;
+  return true;
+}
@@ -0,0 +1,14 @@
+#include "ALPGunGapDigi.hh"
+
+G4ThreadLocal G4Allocator<ALPGunGapDigi>* ALPGunGapDigiAllocator = 0;
+
+ALPGunGapDigi::ALPGunGapDigi()
+: G4VDigi(),
+  fLayer(-1),
+  fPad(-1),
+  fCharge(0.),
+  fTime(0.)
+{}
+
+ALPGunGapDigi::~ALPGunGapDigi()
+{}
@@ -0,0 +1,141 @@
+#include "ALPGunGapDigitizer.hh"
+#include "ALPGunGapHit.hh"
+#include "ALPGunGapDigi.hh"
+
+#include "G4DigiManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace
+{
+  struct PadSignal
+  {
+    G4double charge = 0.;
+    G4double time = DBL_MAX;
+  };
+
+  // Fraction of a Gaussian centred at x that falls into [lo, hi]
+  G4double Share(G4double x, G4double sigma, G4double lo, G4double hi)
+  {
+    const G4double norm = 1. / (std::sqrt(2.) * sigma);
+    return 0.5 * (std::erf((hi - x) * norm) - std::erf((lo - x) * norm));
+  }
+}
+
+ALPGunGapDigitizer::ALPGunGapDigitizer(const G4String& name)
+: G4VDigitizerModule(name),
+  fPadPitch(10. * mm),
+  fWValue(28. * eV),
+  fGain(1.e4),
+  fDiffusion(0.3 * mm),
+  fNoise(0.5),
+  fTimeWindow(100. * ns),
+  fThreshold(2.),
+  fHCID(-1)
+{
+  collectionName.push_back("GapDigiCollection");
+
+  messenger = new G4GenericMessenger(this, "/digi/", "Gap readout digitization");
+  messenger->DeclarePropertyWithUnit("padPitch", "mm", fPadPitch)
+        .SetGuidance("Set readout pad pitch")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclarePropertyWithUnit("wValue", "eV", fWValue)
+        .SetGuidance("Set mean energy per ion pair of the gap gas")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclareProperty("gain", fGain)
+        .SetGuidance("Set gas gain")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclarePropertyWithUnit("diffusion", "mm", fDiffusion)
+        .SetGuidance("Set transverse charge spread for a drift over the full gap")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclareProperty("noise", fNoise)
+        .SetGuidance("Set electronics noise per pad [fC]")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclarePropertyWithUnit("timeWindow", "ns", fTimeWindow)
+        .SetGuidance("Set readout time window after the event start")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclareProperty("threshold", fThreshold)
+        .SetGuidance("Set zero suppression threshold [fC]")
+        .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+ALPGunGapDigitizer::~ALPGunGapDigitizer()
+{
+  delete messenger;
+}
+
+void ALPGunGapDigitizer::Digitize()
+{
+  G4DigiManager* digiManager = G4DigiManager::GetDMpointer();
+  if (fHCID < 0) fHCID = digiManager->GetHitsCollectionID("GapSD/GapHitsCollection");
+  auto hits = static_cast<const ALPGunGapHitsCollection*>(digiManager->GetHitsCollection(fHCID));
+
+  auto digis = new ALPGunGapDigiCollection(moduleName, collectionName[0]);
+  if (!hits) {
+    StoreDigiCollection(digis);
+    return;
+  }
+
+  const G4double femtocoulomb = 1.e-15 * coulomb;
+  std::map<std::pair<G4int, G4int>, PadSignal> pads;
+
+  for (std::size_t i = 0; i < hits->entries(); ++i) {
+    const ALPGunGapHit* hit = (*hits)[i];
+    if (hit->GetTime() < 0. || hit->GetTime() > fTimeWindow) continue;
+
+    const G4ThreeVector& pos = hit->GetLocalPos();
+    const G4ThreeVector& half = hit->GetHalfSize();
+    G4int nPadsX = (G4int)std::ceil(2. * half.x() / fPadPitch);
+    G4int nPadsY = (G4int)std::ceil(2. * half.y() / fPadPitch);
+
+    G4double charge = hit->GetEdep() / fWValue * fGain * eplus / femtocoulomb;
+
+    // Readout is on the +z (Cu) side of the gap
+    G4double drift = std::max(0., half.z() - pos.z());
+    G4double sigma = fDiffusion * std::sqrt(drift / (2. * half.z()));
+
+    G4double x = pos.x() + half.x();
+    G4double y = pos.y() + half.y();
+    G4int ix = std::min(std::max((G4int)(x / fPadPitch), 0), nPadsX - 1);
+    G4int iy = std::min(std::max((G4int)(y / fPadPitch), 0), nPadsY - 1);
+    G4int reach = sigma > 0. ? (G4int)std::ceil(3. * sigma / fPadPitch) : 0;
+
+    for (G4int jx = std::max(ix - reach, 0); jx <= std::min(ix + reach, nPadsX - 1); ++jx) {
+      G4double fx = reach ? Share(x, sigma, jx * fPadPitch, (jx + 1) * fPadPitch) : 1.;
+      for (G4int jy = std::max(iy - reach, 0); jy <= std::min(iy + reach, nPadsY - 1); ++jy) {
+        G4double fy = reach ? Share(y, sigma, jy * fPadPitch, (jy + 1) * fPadPitch) : 1.;
+        if (fx * fy <= 0.) continue;
+        PadSignal& pad = pads[std::make_pair(hit->GetLayer(), jy * nPadsX + jx)];
+        pad.charge += charge * fx * fy;
+        pad.time = std::min(pad.time, hit->GetTime());
+      }
+    }
+  }
+
+  for (const auto& entry : pads) {
+    G4double charge = entry.second.charge + (fNoise > 0. ? G4RandGauss::shoot(0., fNoise) : 0.);
+    if (charge < fThreshold) continue;
+
+    ALPGunGapDigi* digi = new ALPGunGapDigi();
+    digi->SetLayer(entry.first.first);
+    digi->SetPad(entry.first.second);
+    digi->SetCharge(charge);
+    digi->SetTime(entry.second.time);
+    digis->insert(digi);
+  }
+
+  StoreDigiCollection(digis);
+}
@@ -0,0 +1,13 @@
+#include "ALPGunGapHit.hh"
+
+G4ThreadLocal G4Allocator<ALPGunGapHit>* ALPGunGapHitAllocator = 0;
+
+ALPGunGapHit::ALPGunGapHit()
+: G4VHit(),
+  fLayer(-1),
+  fEdep(0.),
+  fTime(0.)
+{}
+
+ALPGunGapHit::~ALPGunGapHit()
+{}
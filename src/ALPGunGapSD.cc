@@ -0,0 +1,50 @@
+#include "ALPGunGapSD.hh"
+
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+#include "G4Step.hh"
+#include "G4TouchableHistory.hh"
+#include "G4AffineTransform.hh"
+#include "G4Box.hh"
+
+ALPGunGapSD::ALPGunGapSD(const G4String& name, const G4String& hitsCollectionName)
+: G4VSensitiveDetector(name),
+  fHitsCollection(0)
+{
+  collectionName.insert(hitsCollectionName);
+}
+
+ALPGunGapSD::~ALPGunGapSD()
+{}
+
+void ALPGunGapSD::Initialize(G4HCofThisEvent* hce)
+{
+  fHitsCollection = new ALPGunGapHitsCollection(SensitiveDetectorName, collectionName[0]);
+  G4int hcID = G4SDManager::GetSDMpointer()->GetCollectionID(fHitsCollection);
+  hce->AddHitsCollection(hcID, fHitsCollection);
+}
+
+G4bool ALPGunGapSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  G4double edep = step->GetTotalEnergyDeposit();
+  if (edep <= 0.) return false;
+
+  const G4StepPoint* pre = step->GetPreStepPoint();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4VTouchable* touchable = pre->GetTouchable();
+
+  // Gap copy numbers are layer + 100 (see ALPGunDetectorConstruction)
+  G4ThreeVector globalPos = 0.5 * (pre->GetPosition() + post->GetPosition());
+  G4ThreeVector localPos = touchable->GetHistory()->GetTopTransform().TransformPoint(globalPos);
+  const G4Box* box = static_cast<const G4Box*>(touchable->GetSolid());
+
+  ALPGunGapHit* hit = new ALPGunGapHit();
+  hit->SetLayer(touchable->GetCopyNumber() - 100);
+  hit->SetEdep(edep);
+  hit->SetTime(0.5 * (pre->GetGlobalTime() + post->GetGlobalTime()));
+  hit->SetLocalPos(localPos);
+  hit->SetHalfSize(G4ThreeVector(box->GetXHalfLength(), box->GetYHalfLength(), box->GetZHalfLength()));
+  fHitsCollection->insert(hit);
+
+  return true;
+}
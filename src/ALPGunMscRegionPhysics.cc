@@ -0,0 +1,34 @@
+#include "ALPGunMscRegionPhysics.hh"
+
+#include "G4EmConfigurator.hh"
+#include "G4EmParameters.hh"
+#include "G4LossTableManager.hh"
+#include "G4RegionStore.hh"
+#include "G4UrbanMscModel.hh"
+#include "G4SystemOfUnits.hh"
+
+ALPGunMscRegionPhysics::ALPGunMscRegionPhysics()
+: G4VPhysicsConstructor("ALPGunMscRegion")
+{}
+
+ALPGunMscRegionPhysics::~ALPGunMscRegionPhysics()
+{}
+
+void ALPGunMscRegionPhysics::ConstructParticle()
+{}
+
+void ALPGunMscRegionPhysics::ConstructProcess()
+{
+  if (!G4RegionStore::GetInstance()->GetRegion("GapRegion", false)) return;
+
+  G4EmParameters::Instance()->SetMscStepLimitType(fUseSafety);
+
+  G4EmConfigurator* config = G4LossTableManager::Instance()->EmConfigurator();
+  for (const char* particle : {"e-", "e+"}) {
+    G4UrbanMscModel* msc = new G4UrbanMscModel();
+    msc->SetStepLimitType(fUseDistanceToBoundary);
+    // Keep the global G4EmParameters from overriding the step limit type
+    msc->SetLocked(true);
+    config->SetExtraEmModel(particle, "msc", msc, "GapRegion", 0., 100*MeV);
+  }
+}
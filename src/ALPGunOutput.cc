@@ -0,0 +1,233 @@
+#include "ALPGunOutput.hh"
+
+#include "G4RootAnalysisManager.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+  // Rows filled by the current thread that are not yet handed to the writer
+  std::vector<G4double>& ThreadBatch()
+  {
+    static thread_local std::vector<G4double> batch;
+    return batch;
+  }
+}
+
+ALPGunOutput* ALPGunOutput::Instance()
+{
+  // Never deleted: the messenger must not outlive the UI manager at exit
+  static ALPGunOutput* instance = new ALPGunOutput;
+  return instance;
+}
+
+ALPGunOutput::ALPGunOutput()
+: fBackend("root"),
+  fStreamPath("ALPGun.stream"),
+  fBatchSize(4096),
+  fMaxQueued(16),
+  fUsers(0),
+  fFd(-1),
+  fStopping(false),
+  fBroken(false),
+  fTotalRows(0)
+{
+  // Shared between threads, so the commands are applied once on the master
+  messenger = new G4GenericMessenger(this, "/output/", "DAMSA row output");
+  messenger->DeclareProperty("backend", fBackend)
+        .SetGuidance("Select where DAMSA rows go: root or stream")
+        .SetCandidates("root stream")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("streamPath", fStreamPath)
+        .SetGuidance("Named pipe to stream to, or unix:<path> for a local socket")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("batchSize", fBatchSize)
+        .SetGuidance("Set number of rows per streamed batch")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+  messenger->DeclareProperty("maxQueuedBatches", fMaxQueued)
+        .SetGuidance("Set number of batches buffered before workers wait for the reader")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+}
+
+ALPGunOutput::~ALPGunOutput()
+{
+  delete messenger;
+}
+
+void ALPGunOutput::Open()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  if (fUsers++ > 0 || !IsStreaming()) return;
+
+  const G4String prefix = "unix:";
+  if (fStreamPath.compare(0, prefix.size(), prefix) == 0) {
+    fFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, fStreamPath.c_str() + prefix.size(), sizeof(addr.sun_path) - 1);
+    if (fFd >= 0 && connect(fFd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+      close(fFd);
+      fFd = -1;
+    }
+  }
+  else {
+    struct stat st;
+    if (stat(fStreamPath.c_str(), &st) != 0) mkfifo(fStreamPath.c_str(), 0644);
+    // Blocks until the reader has opened the other end of the pipe
+    fFd = open(fStreamPath.c_str(), O_WRONLY | O_TRUNC);
+  }
+
+  if (fFd < 0) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open output stream " << fStreamPath << ": " << std::strerror(errno);
+    G4Exception("ALPGunOutput::Open()", "ALPGunOutput001", FatalException, ed);
+    return;
+  }
+
+  // A reader that goes away is reported by write() instead of killing the job
+  std::signal(SIGPIPE, SIG_IGN);
+
+  const char magic[8] = {'A', 'L', 'P', 'G', 'S', 'T', 'R', 'M'};
+  const std::uint32_t version = 1;
+  const std::uint32_t nColumns = ALPGunRow::nColumns;
+  WriteBytes(magic, sizeof(magic));
+  WriteBytes(&version, sizeof(version));
+  WriteBytes(&nColumns, sizeof(nColumns));
+  for (G4int i = 0; i < ALPGunRow::nColumns; ++i) {
+    const char* name = ALPGunRow::ColumnNames()[i];
+    const std::uint8_t type = 1;
+    const std::uint16_t length = std::strlen(name);
+    WriteBytes(&type, sizeof(type));
+    WriteBytes(&length, sizeof(length));
+    WriteBytes(name, length);
+  }
+
+  fStopping = false;
+  fTotalRows = 0;
+  fWriter = std::thread(&ALPGunOutput::WriteLoop, this);
+  G4cout << "Streaming DAMSA rows to " << fStreamPath << G4endl;
+}
+
+void ALPGunOutput::Close()
+{
+  if (IsStreaming()) FlushBatch(ThreadBatch());
+
+  std::unique_lock<std::mutex> lock(fMutex);
+  if (--fUsers > 0 || fFd < 0) return;
+
+  fStopping = true;
+  fNotEmpty.notify_all();
+  lock.unlock();
+  fWriter.join();
+
+  const char tag[4] = {'E', 'N', 'D', '\0'};
+  const std::uint64_t total = fTotalRows;
+  WriteBytes(tag, sizeof(tag));
+  WriteBytes(&total, sizeof(total));
+  close(fFd);
+  fFd = -1;
+  fBroken = false;
+  G4cout << "Streamed " << total << " DAMSA rows to " << fStreamPath << G4endl;
+}
+
+void ALPGunOutput::Fill(const ALPGunRow& row)
+{
+  if (!IsStreaming()) {
+    auto analysisManager = G4RootAnalysisManager::Instance();
+    for (G4int i = 0; i < ALPGunRow::nColumns; ++i) {
+      analysisManager->FillNtupleDColumn(i, row.values[i]);
+    }
+    analysisManager->AddNtupleRow();
+    return;
+  }
+
+  std::vector<G4double>& batch = ThreadBatch();
+  batch.insert(batch.end(), row.values, row.values + ALPGunRow::nColumns);
+  if ((G4int)batch.size() >= fBatchSize * ALPGunRow::nColumns) FlushBatch(batch);
+}
+
+void ALPGunOutput::FlushBatch(std::vector<G4double>& batch)
+{
+  if (batch.empty()) return;
+
+  // Rows are collected row by row, the stream is columnar
+  const std::size_t nRows = batch.size() / ALPGunRow::nColumns;
+  std::vector<G4double> columns(batch.size());
+  for (std::size_t r = 0; r < nRows; ++r) {
+    for (G4int c = 0; c < ALPGunRow::nColumns; ++c) {
+      columns[c * nRows + r] = batch[r * ALPGunRow::nColumns + c];
+    }
+  }
+  batch.clear();
+
+  std::unique_lock<std::mutex> lock(fMutex);
+  fNotFull.wait(lock, [this] { return (G4int)fQueue.size() < fMaxQueued || fBroken; });
+  if (fBroken) return;
+  fQueue.push_back(std::move(columns));
+  fNotEmpty.notify_one();
+}
+
+void ALPGunOutput::WriteLoop()
+{
+  while (true) {
+    std::unique_lock<std::mutex> lock(fMutex);
+    fNotEmpty.wait(lock, [this] { return !fQueue.empty() || fStopping; });
+    if (fQueue.empty()) return;
+    std::vector<G4double> columns = std::move(fQueue.front());
+    fQueue.pop_front();
+    fNotFull.notify_one();
+    lock.unlock();
+
+    const char tag[4] = {'B', 'T', 'C', 'H'};
+    const std::uint32_t nRows = columns.size() / ALPGunRow::nColumns;
+    G4bool ok = WriteBytes(tag, sizeof(tag))
+             && WriteBytes(&nRows, sizeof(nRows))
+             && WriteBytes(columns.data(), columns.size() * sizeof(G4double));
+
+    lock.lock();
+    if (ok) {
+      fTotalRows += nRows;
+      continue;
+    }
+    // Reader is gone: drop what is left and stop throttling the workers
+    fBroken = true;
+    fQueue.clear();
+    fNotFull.notify_all();
+    G4Exception("ALPGunOutput::WriteLoop()", "ALPGunOutput002", JustWarning,
+                "Output stream closed by the reader, remaining rows are dropped");
+    return;
+  }
+}
+
+G4bool ALPGunOutput::WriteBytes(const void* data, std::size_t size)
+{
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = write(fFd, bytes, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
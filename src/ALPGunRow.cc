@@ -0,0 +1,10 @@
+#include "ALPGunRow.hh"
+
+const char* const* ALPGunRow::ColumnNames()
+{
+  static const char* const names[nColumns] = {
+    "evtID", "PDGID", "E", "t", "x", "y", "z",
+    "px", "py", "pz", "Mother", "Charge", "PPIPZ"
+  };
+  return names;
+}
@@ -1,4 +1,13 @@
 #include "ALPGunRun.hh"
 
-ALPGunRun::ALPGunRun() : G4Run() {}
+ALPGunRun::ALPGunRun() : G4Run(), fAccepted(0), fRejected(0), fSteps(0.) {}
 ALPGunRun::~ALPGunRun() = default;
+
+void ALPGunRun::Merge(const G4Run* run)
+{
+  const ALPGunRun* localRun = static_cast<const ALPGunRun*>(run);
+  fAccepted += localRun->fAccepted;
+  fRejected += localRun->fRejected;
+  fSteps += localRun->fSteps;
+  G4Run::Merge(run);
+}
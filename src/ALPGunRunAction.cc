@@ -2,25 +2,50 @@
 #include "ALPGunPrimaryGeneratorAction.hh"
 #include "ALPGunDetectorConstruction.hh"
 #include "ALPGunRun.hh"
+#include "ALPGunOutput.hh"
+#include "ALPGunConvergence.hh"
+#include "ALPGunEventInfo.hh"
+#include "ALPGunRow.hh"
 
 #include "G4RootAnalysisManager.hh"
 #include "G4RunManager.hh"
+#include "G4SDManager.hh"
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
-#include "G4GenericMessenger.hh"
 
 #include <math.h>
+#include <string>
 
 ALPGunRunAction::ALPGunRunAction()
-: G4UserRunAction()
+: G4UserRunAction(),
+  fDigitize(false),
+  fWriteSummary(false),
+  fDigiNtupleId(-1),
+  fSummaryNtupleId(-1)
 {
   auto analysisManager = G4RootAnalysisManager::Instance();
+  // Created here so their commands exist before the macro runs
+  ALPGunOutput::Instance();
+  ALPGunConvergence::Instance();
+
+  digiMessenger = new G4GenericMessenger(this, "/digi/", "Gap readout digitization");
+  digiMessenger->DeclareProperty("enable", fDigitize)
+        .SetGuidance("Digitize the Gap layers and write pads above threshold")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  summaryMessenger = new G4GenericMessenger(this, "/summary/", "Per-event summary");
+  summaryMessenger->DeclareProperty("enable", fWriteSummary)
+        .SetGuidance("Write one Summary row per event (layer and radial energies, multiplicities)")
+        .SetStates(G4State_PreInit, G4State_Idle);
 }
 
 ALPGunRunAction::~ALPGunRunAction()
-{}
+{
+  delete digiMessenger;
+  delete summaryMessenger;
+}
 
 G4Run* ALPGunRunAction::GenerateRun()
 {
@@ -41,26 +66,82 @@ void ALPGunRunAction::BeginOfRunAction(const G4Run*)
      (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
 
   analysisManager->CreateNtuple("DAMSA", "ECal");
-  analysisManager->CreateNtupleDColumn("evtID");
-  analysisManager->CreateNtupleDColumn("PDGID");
-  analysisManager->CreateNtupleDColumn("E");
-  analysisManager->CreateNtupleDColumn("t");
-  analysisManager->CreateNtupleDColumn("x");
-  analysisManager->CreateNtupleDColumn("y");
-  analysisManager->CreateNtupleDColumn("z");
-  analysisManager->CreateNtupleDColumn("px");
-  analysisManager->CreateNtupleDColumn("py");
-  analysisManager->CreateNtupleDColumn("pz");
-  analysisManager->CreateNtupleDColumn("Mother");
-  analysisManager->CreateNtupleDColumn("Charge");
-  analysisManager->CreateNtupleDColumn("PPIPZ");
+  for (G4int i = 0; i < ALPGunRow::nColumns; ++i) {
+    analysisManager->CreateNtupleDColumn(ALPGunRow::ColumnNames()[i]);
+  }
   analysisManager->FinishNtuple();
 
+  // Zero-suppressed Gap pads, filled by ALPGunEventAction
+  fDigiNtupleId = -1;
+  if (fDigitize) {
+    fDigiNtupleId = analysisManager->CreateNtuple("Digi", "Gap pads");
+    analysisManager->CreateNtupleIColumn("evtID");
+    analysisManager->CreateNtupleIColumn("layer");
+    analysisManager->CreateNtupleIColumn("pad");
+    analysisManager->CreateNtupleFColumn("charge");
+    analysisManager->CreateNtupleFColumn("t");
+    analysisManager->FinishNtuple();
+  }
+
+  // One row per event, filled by ALPGunEventAction
+  fSummaryNtupleId = -1;
+  if (fWriteSummary) {
+    fSummaryNtupleId = analysisManager->CreateNtuple("Summary", "Event summary");
+    analysisManager->CreateNtupleIColumn("evtID");
+    analysisManager->CreateNtupleDColumn("EGap");
+    analysisManager->CreateNtupleDColumn("EAbs");
+    for (G4int i = 0; i < nSummaryLayers; ++i) {
+      analysisManager->CreateNtupleDColumn("EGap" + std::to_string(i));
+    }
+    for (G4int i = 0; i < nSummaryLayers; ++i) {
+      analysisManager->CreateNtupleDColumn("EAbs" + std::to_string(i));
+    }
+    for (G4int i = 0; i < ALPGunEventInfo::nRadialBins; ++i) {
+      analysisManager->CreateNtupleDColumn("ER" + std::to_string(i));
+    }
+    const char* species[ALPGunEventInfo::nSpecies] = {
+      "nGamma", "nElectron", "nPositron", "nNeutron", "nProton", "nOther"
+    };
+    for (G4int i = 0; i < ALPGunEventInfo::nSpecies; ++i) {
+      analysisManager->CreateNtupleIColumn(species[i]);
+    }
+    analysisManager->CreateNtupleIColumn("nSteps");
+    analysisManager->FinishNtuple();
+  }
 
+  // Gap hits are only needed for digitization, skip them otherwise
+  G4SDManager* sdManager = G4SDManager::GetSDMpointerIfExist();
+  if (sdManager) sdManager->Activate("GapSD", fDigitize);
+
+  ALPGunOutput::Instance()->Open();
+  if (IsMaster()) ALPGunConvergence::Instance()->BeginRun();
+  if (IsMaster()) fTimer.Start();
 }
 
 void ALPGunRunAction::EndOfRunAction(const G4Run* run)
 {
+  ALPGunOutput::Instance()->Close();
+  if (IsMaster()) ALPGunConvergence::Instance()->Report();
+
+  const ALPGunRun* alpRun = static_cast<const ALPGunRun*>(run);
+  if (IsMaster() && run->GetNumberOfEvent() > 0) {
+    // Compare with and without /detector/navigationProfile
+    fTimer.Stop();
+    G4cout << "--------------------Performance---------------------" << G4endl
+           << " Steps per event     " << alpRun->GetNumberOfSteps() / run->GetNumberOfEvent() << G4endl
+           << " Wall time per event " << fTimer.GetRealElapsed() / run->GetNumberOfEvent() * 1000. << " ms" << G4endl
+           << "----------------------------------------------------" << G4endl;
+  }
+
+  G4int nTriggered = alpRun->GetNumberOfAccepted() + alpRun->GetNumberOfRejected();
+  if (IsMaster() && nTriggered > 0) {
+    G4cout << "--------------------Trigger-------------------------" << G4endl
+           << " Accepted " << alpRun->GetNumberOfAccepted()
+           << ", rejected " << alpRun->GetNumberOfRejected()
+           << " of " << nTriggered << " events" << G4endl
+           << "----------------------------------------------------" << G4endl;
+  }
+
   auto analysisManager = G4RootAnalysisManager::Instance();
   analysisManager->Write();
   analysisManager->CloseFile(); 
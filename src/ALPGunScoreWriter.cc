@@ -0,0 +1,93 @@
+#include "ALPGunScoreWriter.hh"
+
+#include "G4VScoringMesh.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+  template <typename T>
+  void Put(std::ostream& out, const T& value)
+  {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void PutString(std::ostream& out, const G4String& s)
+  {
+    Put(out, (std::uint16_t)s.size());
+    out.write(s.data(), s.size());
+  }
+}
+
+ALPGunScoreWriter::ALPGunScoreWriter()
+: G4VScoreWriter()
+{}
+
+ALPGunScoreWriter::~ALPGunScoreWriter()
+{}
+
+void ALPGunScoreWriter::DumpQuantityToFile(const G4String& psName, const G4String& fileName, const G4String&)
+{
+  std::ofstream out(fileName, std::ios::binary);
+  if (!out) {
+    G4cerr << "ALPGunScoreWriter: cannot open " << fileName << G4endl;
+    return;
+  }
+  WriteQuantity(out, psName);
+}
+
+void ALPGunScoreWriter::DumpAllQuantitiesToFile(const G4String& fileName, const G4String&)
+{
+  std::ofstream out(fileName, std::ios::binary);
+  if (!out) {
+    G4cerr << "ALPGunScoreWriter: cannot open " << fileName << G4endl;
+    return;
+  }
+  for (const auto& entry : fScoringMesh->GetScoreMap()) WriteQuantity(out, entry.first);
+}
+
+G4bool ALPGunScoreWriter::WriteQuantity(std::ostream& out, const G4String& psName)
+{
+  G4VScoringMesh::MeshScoreMap scoreMap = fScoringMesh->GetScoreMap();
+  auto quantity = scoreMap.find(psName);
+  if (quantity == scoreMap.end()) {
+    G4cerr << "ALPGunScoreWriter: no quantity " << psName << " in mesh "
+           << fScoringMesh->GetWorldName() << G4endl;
+    return false;
+  }
+
+  fScoringMesh->GetNumberOfSegments(fNMeshSegments);
+  const G4double unitValue = fScoringMesh->GetPSUnitValue(psName);
+  const G4ThreeVector size = fScoringMesh->GetSize();
+  const G4ThreeVector translation = fScoringMesh->GetTranslation();
+
+  const char magic[8] = {'A', 'L', 'P', 'G', 'M', 'E', 'S', 'H'};
+  out.write(magic, sizeof(magic));
+  Put(out, (std::uint32_t)1);
+  Put(out, (std::uint8_t)(fScoringMesh->GetShape() == MeshShape::cylinder ? 1 : 0));
+  for (G4int i = 0; i < 3; ++i) Put(out, (std::uint32_t)fNMeshSegments[i]);
+  for (G4int i = 0; i < 3; ++i) Put(out, (G4double)(size[i] / mm));
+  for (G4int i = 0; i < 3; ++i) Put(out, (G4double)(translation[i] / mm));
+  PutString(out, fScoringMesh->GetWorldName());
+  PutString(out, psName);
+  PutString(out, fScoringMesh->GetPSUnit(psName));
+
+  // Dense grid, cells without a score stay zero
+  std::vector<float> grid((std::size_t)fNMeshSegments[0] * fNMeshSegments[1] * fNMeshSegments[2], 0.f);
+  for (const auto& cell : *quantity->second->GetMap()) {
+    if (cell.first >= 0 && (std::size_t)cell.first < grid.size()) {
+      grid[cell.first] = cell.second->sum_wx() / unitValue * fact;
+    }
+  }
+  out.write(reinterpret_cast<const char*>(grid.data()), grid.size() * sizeof(float));
+
+  if (verboseLevel > 0) {
+    G4cout << "ALPGunScoreWriter: wrote " << fScoringMesh->GetWorldName() << "/" << psName
+           << " (" << grid.size() << " cells)" << G4endl;
+  }
+  return (G4bool)out;
+}
@@ -0,0 +1,63 @@
+#include "ALPGunStackingAction.hh"
+#include "ALPGunEventAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4StackManager.hh"
+#include "G4Track.hh"
+#include "G4Version.hh"
+#include "G4SystemOfUnits.hh"
+
+ALPGunStackingAction::ALPGunStackingAction(const ALPGunEventAction* eventAction)
+: G4UserStackingAction(),
+  fEventAction(eventAction),
+  fOffload(false),
+  fMinEnergy(0.),
+  fStackDepth(0)
+{
+  messenger = new G4GenericMessenger(this, "/subEvent/", "Sub-event parallel transport");
+  messenger->DeclarePropertyWithUnit("minEnergy", "GeV", fMinEnergy)
+        .SetGuidance("Offload secondaries above this kinetic energy, 0 to disable")
+        .SetStates(G4State_PreInit, G4State_Idle);
+
+  messenger->DeclareProperty("stackDepth", fStackDepth)
+        .SetGuidance("Offload secondaries once the urgent stack holds this many tracks, 0 to disable")
+        .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+ALPGunStackingAction::~ALPGunStackingAction()
+{
+  delete messenger;
+}
+
+G4ClassificationOfNewTrack ALPGunStackingAction::ClassifyNewTrack(const G4Track* track)
+{
+#if G4VERSION_NUMBER >= 1130
+  if (!fOffload || track->GetParentID() == 0) return fUrgent;
+
+  G4bool energetic = fMinEnergy > 0. && track->GetKineticEnergy() > fMinEnergy;
+  G4bool deep = fStackDepth > 0 && stackManager->GetNUrgentTrack() > fStackDepth;
+  if (energetic || deep) return fSubEvent_0;
+#else
+  (void)track;
+#endif
+  return fUrgent;
+}
+
+void ALPGunStackingAction::PrepareNewEvent()
+{
+  fOffload = false;
+#if G4VERSION_NUMBER >= 1130
+  if (fMinEnergy <= 0. && fStackDepth <= 0) return;
+  if (G4RunManager::GetRunManager()->GetRunManagerType() != G4RunManager::subEventWorkerRM) return;
+  if (fEventAction->NeedsCompleteEvents()) {
+    static G4ThreadLocal G4bool warned = false;
+    if (!warned) {
+      G4Exception("ALPGunStackingAction::PrepareNewEvent()", "ALPGunStack001", JustWarning,
+                  "/subEvent/ offloading is off: trigger, digitization, summary or adaptive run need complete events");
+      warned = true;
+    }
+    return;
+  }
+  fOffload = true;
+#endif
+}
@@ -1,9 +1,12 @@
 #include "ALPGunSteppingAction.hh"
 #include "ALPGunDetectorConstruction.hh"
+#include "ALPGunEventAction.hh"
 
-#include "G4RootAnalysisManager.hh"
+#include "ALPGunOutput.hh"
+#include "ALPGunRow.hh"
 #include "G4Step.hh"
 #include "G4Event.hh"
+#include "G4EventManager.hh"
 #include "G4RunManager.hh"
 #include "G4LogicalVolume.hh"
 #include "G4SystemOfUnits.hh"
@@ -11,8 +14,9 @@
 #include "G4String.hh"
 #include "ALPGunTrackingInfo.hh"
 
-ALPGunSteppingAction::ALPGunSteppingAction()
+ALPGunSteppingAction::ALPGunSteppingAction(ALPGunEventAction* eventAction)
 : G4UserSteppingAction(),
+  fEventAction(eventAction),
   fScoringVolume1(0),
   fScoringVolume2(0),
   fScoringVolume3(0)
@@ -28,7 +32,6 @@ void ALPGunSteppingAction::UserSteppingAction(const G4Step* step)
   fScoringVolume2 = logicDet;
   */
 
-  auto analysisManager = G4RootAnalysisManager::Instance();
   // get volume of the current step
   if (!fScoringVolume1) { 
     const ALPGunDetectorConstruction* detectorConstruction
@@ -39,6 +42,7 @@ void ALPGunSteppingAction::UserSteppingAction(const G4Step* step)
     fScoringVolume3 = detectorConstruction->GetScoringVolume3();   
   }
   G4Track* tr = step->GetTrack();
+  fEventAction->CountStep();
   /*
   if (tr->GetTrackID() == 1 && tr->GetCurrentStepNumber() == 1) {
     auto* Info = new ALPGunTrackInfo(0, 0);
@@ -47,6 +51,7 @@ void ALPGunSteppingAction::UserSteppingAction(const G4Step* step)
     */
   
     if (tr->GetCurrentStepNumber() == 1) const_cast<G4Track*>(tr)->SetUserInformation(new ALPGunTrackInfo(tr->GetPosition().perp(), tr->GetPosition().z()));
+    if (tr->GetCurrentStepNumber() == 1) fEventAction->CountTrack(tr->GetParticleDefinition()->GetPDGEncoding());
 
 G4String preVolume = step->GetPreStepPoint()->GetTouchableHandle()->GetVolume()->GetLogicalVolume()->GetName();
 G4String postVolume = step->GetPostStepPoint()->GetTouchableHandle()->GetVolume() != NULL ? 
@@ -81,22 +86,11 @@ G4String postVolume = step->GetPostStepPoint()->GetTouchableHandle()->GetVolume(
 
 // Absorber 경계를 지날 때 (진입 시점)
 if (((preVolume != "Absorber") and (postVolume == "Absorber")) || ((preVolume != "Gap") and (postVolume == "Gap"))) {
-    ALPGunTrackInfo* trackInfo = (ALPGunTrackInfo*)(tr->GetUserInformation());
-    
     // Ntuple 기록 로직...
-    analysisManager->FillNtupleDColumn(0, G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID());
-    analysisManager->FillNtupleDColumn(1, tr->GetParticleDefinition()->GetPDGEncoding());
-    analysisManager->FillNtupleDColumn(2, tr->GetKineticEnergy()/MeV);
-    analysisManager->FillNtupleDColumn(3, tr->GetGlobalTime()/ns);
-    analysisManager->FillNtupleDColumn(4, tr->GetPosition()[0]/mm);
-    analysisManager->FillNtupleDColumn(5, tr->GetPosition()[1]/mm);
-    analysisManager->FillNtupleDColumn(6, tr->GetPosition()[2]/mm);
-    analysisManager->FillNtupleDColumn(7, tr->GetMomentum()[0]/MeV);
-    analysisManager->FillNtupleDColumn(8, tr->GetMomentum()[1]/MeV);
-    analysisManager->FillNtupleDColumn(9, tr->GetMomentum()[2]/MeV);
-    analysisManager->FillNtupleDColumn(10, trackInfo->GetTag());
-    analysisManager->FillNtupleDColumn(11, trackInfo->GetPri());
-    analysisManager->AddNtupleRow();
+    FillRow(tr, 0.);
+    if (postVolume == "Absorber") {
+      fEventAction->AddEntranceEnergy(step->GetPostStepPoint()->GetTouchable()->GetCopyNumber(), tr->GetKineticEnergy());
+    }
     //track->SetTrackStatus(fStopAndKill);
 
 /*
@@ -136,30 +130,28 @@ if (((preVolume != "Absorber") and (postVolume == "Absorber")) || ((preVolume !=
            << " | Pri: " << updatedInfo->GetPri() << G4endl;
            */
 }
+// Per-layer sums for the end-of-event bookkeeping (copy numbers: Absorber = layer, Gap = layer + 100)
+G4double edep = step->GetTotalEnergyDeposit();
+if (edep > 0) {
+  G4int copyNo = step->GetPreStepPoint()->GetTouchable()->GetCopyNumber();
+  if (preVolume == "Gap") fEventAction->AddGapEdep(copyNo - 100, edep);
+  else if (preVolume == "Absorber") fEventAction->AddAbsorberEdep(copyNo, edep);
+  if (preVolume == "Gap" || preVolume == "Absorber") {
+    fEventAction->AddRadialEdep(step->GetPostStepPoint()->GetPosition().perp(), edep);
+  }
+}
+
 //if(tr->GetPosition()[2] > 0) tr->SetTrackStatus(fStopAndKill);
 // Absorber 내부에서 첫 번째 스텝일 때
-if (preVolume == "Absorber" || preVolume == "Gap") {
+// Gap deposits go through the digitization stage instead when it is enabled
+G4bool digitizeGap = fEventAction->IsDigitizing();
+if (preVolume == "Absorber" || (preVolume == "Gap" && !digitizeGap)) {
   //tr->SetTrackStatus(fStopAndKill);
     //if (tr->GetCurrentStepNumber() == 1) {
     ///*
       if (step->GetTotalEnergyDeposit() > 0) {
-        ALPGunTrackInfo* trackInfo = (ALPGunTrackInfo*)(tr->GetUserInformation());
-///*        
         // Ntuple 기록 로직 (동일)...
-        analysisManager->FillNtupleDColumn(0, G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID());
-        analysisManager->FillNtupleDColumn(1, tr->GetParticleDefinition()->GetPDGEncoding());
-        analysisManager->FillNtupleDColumn(2, tr->GetKineticEnergy()/MeV);
-        analysisManager->FillNtupleDColumn(3, tr->GetGlobalTime()/ns);
-        analysisManager->FillNtupleDColumn(4, tr->GetPosition()[0]/mm);
-        analysisManager->FillNtupleDColumn(5, tr->GetPosition()[1]/mm);
-        analysisManager->FillNtupleDColumn(6, tr->GetPosition()[2]/mm);
-        analysisManager->FillNtupleDColumn(7, tr->GetMomentum()[0]/MeV);
-        analysisManager->FillNtupleDColumn(8, tr->GetMomentum()[1]/MeV);
-        analysisManager->FillNtupleDColumn(9, tr->GetMomentum()[2]/MeV);
-        analysisManager->FillNtupleDColumn(10, trackInfo->GetTag());
-        analysisManager->FillNtupleDColumn(11, trackInfo->GetPri());
-        analysisManager->FillNtupleDColumn(12, step->GetTotalEnergyDeposit());
-        analysisManager->AddNtupleRow();
+        FillRow(tr, step->GetTotalEnergyDeposit());
       }
 //*/
 /*
@@ -233,4 +225,26 @@ const auto* secondaries = step->GetSecondaryInCurrentStep();
     }
 }
 
-}
\ No newline at end of file
+}
+
+void ALPGunSteppingAction::FillRow(const G4Track* tr, G4double edep) const
+{
+  const ALPGunTrackInfo* trackInfo = (const ALPGunTrackInfo*)(tr->GetUserInformation());
+
+  ALPGunRow row;
+  row.values[0] = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+  row.values[1] = tr->GetParticleDefinition()->GetPDGEncoding();
+  row.values[2] = tr->GetKineticEnergy()/MeV;
+  row.values[3] = tr->GetGlobalTime()/ns;
+  row.values[4] = tr->GetPosition()[0]/mm;
+  row.values[5] = tr->GetPosition()[1]/mm;
+  row.values[6] = tr->GetPosition()[2]/mm;
+  row.values[7] = tr->GetMomentum()[0]/MeV;
+  row.values[8] = tr->GetMomentum()[1]/MeV;
+  row.values[9] = tr->GetMomentum()[2]/MeV;
+  row.values[10] = trackInfo->GetTag();
+  row.values[11] = trackInfo->GetPri();
+  row.values[12] = edep;
+  if (fEventAction->IsBuffering()) fEventAction->BufferRow(row);
+  else ALPGunOutput::Instance()->Fill(row);
+}
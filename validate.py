@@ -0,0 +1,145 @@
+#!/cvmfs/sft.cern.ch/lcg/views/LCG_106/x86_64-el9-gcc13-dbg/bin/python3
+# Physics-equivalence check of a candidate configuration against a reference.
+#
+#   ./validate.py ref.mac cand.mac [--events 2000] [--seeds 12345 67890]
+#                 [--cand-seeds 24680 13579] [--alpha 0.01]
+#                 [--ref-env PHYSLIST=FTFP_BERT_HP] [--cand-env PHYSLIST=FTFP_BERT]
+#
+# Both macros set up detector and gun (including /run/initialize) but must not
+# call /run/beamOn. Each is run with /summary/enable and its own fixed seeds, so
+# that the two samples are independent as the two-sample tests assume, then the
+# Summary ntuples are compared:
+#   - per-layer and total Gap/Absorber energy: Kolmogorov-Smirnov and
+#     Anderson-Darling two-sample tests
+#   - mean longitudinal and lateral profiles: chi2 with per-bin standard errors
+#   - species multiplicities: chi2 homogeneity test on the count histograms
+# All tests share a Bonferroni-corrected alpha. The Anderson-Darling p-values
+# come from a permutation test with enough resamples to resolve that alpha
+# (scipy's tabulated p-values stop at 0.001). Exit status 0 means PASS.
+#
+# Speed is compared on the per-event wall time printed by ALPGunRunAction, so
+# initialization (physics tables, geometry) does not enter the ratio.
+
+import argparse, os, re, subprocess, sys
+import numpy as np
+import uproot
+from scipy import stats
+
+nLayers = 6
+nRadialBins = 10
+species = ['nGamma', 'nElectron', 'nPositron', 'nNeutron', 'nProton', 'nOther']
+
+tmpMac = """/random/setSeeds {s1} {s2}
+/control/execute {macro}
+/summary/enable true
+/analysis/setFileName {fName}
+/run/beamOn {nEvt}
+"""
+
+def runConfig(name, macro, env, seeds, args):
+    fName = 'validate_' + name
+    macName = fName + '.mac'
+    with open(macName, 'w') as f:
+        f.write(tmpMac.format(s1=seeds[0], s2=seeds[1], macro=os.path.abspath(macro),
+                              fName=fName, nEvt=args.events))
+
+    runEnv = dict(os.environ)
+    for kv in env:
+        k, v = kv.split('=', 1)
+        runEnv[k] = v
+
+    with open(fName + '.log', 'w') as log:
+        subprocess.run([args.exe, macName], env=runEnv, stdout=log, stderr=subprocess.STDOUT, check=True)
+
+    # Event loop only, as printed at the end of the run
+    with open(fName + '.log') as log:
+        found = re.findall(r'Wall time per event\s+(\S+) ms', log.read())
+    if not found:
+        sys.exit('{}: no per-event wall time in {}.log'.format(name, fName))
+    msPerEvent = float(found[-1])
+
+    with uproot.open(fName + '.root') as f:
+        data = f['Summary'].arrays(library='np')
+    if len(data['evtID']) == 0:
+        sys.exit('{}: empty Summary ntuple, see {}.log'.format(name, fName))
+    return data, msPerEvent
+
+def profileChi2(ref, cand):
+    m1, m2 = ref.mean(axis=0), cand.mean(axis=0)
+    v = ref.var(axis=0, ddof=1) / len(ref) + cand.var(axis=0, ddof=1) / len(cand)
+    use = v > 0
+    chi2 = np.sum((m1[use] - m2[use])**2 / v[use])
+    return stats.chi2.sf(chi2, use.sum()) if use.any() else 1.
+
+def countChi2(ref, cand):
+    # Merge neighbouring count values until every bin holds at least 10 entries
+    edges = np.unique(np.concatenate([ref, cand]))
+    table = np.array([[np.sum(ref == e) for e in edges], [np.sum(cand == e) for e in edges]], dtype=float)
+    merged = []
+    acc = np.zeros(2)
+    for col in table.T:
+        acc += col
+        if acc.sum() >= 10:
+            merged.append(acc)
+            acc = np.zeros(2)
+    if acc.sum() > 0:
+        if merged: merged[-1] = merged[-1] + acc
+        else: merged.append(acc)
+    if len(merged) < 2: return 1.
+    return stats.chi2_contingency(np.array(merged).T)[1]
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare a candidate configuration to a reference')
+    parser.add_argument('reference')
+    parser.add_argument('candidate')
+    parser.add_argument('--events', type=int, default=2000)
+    parser.add_argument('--seeds', type=int, nargs=2, default=[12345, 67890], help='reference seeds')
+    parser.add_argument('--cand-seeds', type=int, nargs=2, default=[24680, 13579])
+    parser.add_argument('--alpha', type=float, default=0.01)
+    parser.add_argument('--ref-env', nargs='*', default=[])
+    parser.add_argument('--cand-env', nargs='*', default=[])
+    parser.add_argument('--exe', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'ALPGun'))
+    args = parser.parse_args()
+
+    if args.cand_seeds == args.seeds:
+        sys.exit('reference and candidate need different seeds for independent samples')
+    ref, tRef = runConfig('reference', args.reference, args.ref_env, args.seeds, args)
+    cand, tCand = runConfig('candidate', args.candidate, args.cand_env, args.cand_seeds, args)
+
+    results = []
+    energies = ['EGap', 'EAbs'] + ['EGap{}'.format(i) for i in range(nLayers)] + ['EAbs{}'.format(i) for i in range(nLayers)]
+    for col in energies:
+        results.append(('KS ' + col, stats.ks_2samp(ref[col], cand[col]).pvalue))
+    adColumns = [col for col in energies if np.ptp(np.concatenate([ref[col], cand[col]])) > 0]
+
+    longi = lambda d: np.stack([d['EGap{}'.format(i)] + d['EAbs{}'.format(i)] for i in range(nLayers)], axis=1)
+    lateral = lambda d: np.stack([d['ER{}'.format(i)] for i in range(nRadialBins)], axis=1)
+    results.append(('chi2 longitudinal profile', profileChi2(longi(ref), longi(cand))))
+    results.append(('chi2 lateral profile', profileChi2(lateral(ref), lateral(cand))))
+
+    for col in species:
+        results.append(('chi2 ' + col, countChi2(ref[col], cand[col])))
+
+    alpha = args.alpha / (len(results) + len(adColumns))
+    # Smallest permutation p-value is 1/(n+1), keep it well below alpha
+    nResamples = int(np.ceil(4. / alpha))
+    method = stats.PermutationMethod(n_resamples=nResamples, random_state=args.seeds[0])
+    for col in adColumns:
+        results.append(('AD ' + col, stats.anderson_ksamp([ref[col], cand[col]], method=method).pvalue))
+    failed = [r for r in results if r[1] < alpha]
+
+    print('{:<30} {:>10}'.format('test', 'p-value'))
+    for name, p in results:
+        print('{:<30} {:>10.4g} {}'.format(name, p, 'FAIL' if p < alpha else ''))
+    print('')
+    print('events       : {} reference, {} candidate'.format(len(ref['evtID']), len(cand['evtID'])))
+    print('time/event   : {:.3g} ms reference, {:.3g} ms candidate'.format(tRef, tCand))
+    print('speed ratio  : {:.2f}x'.format(tRef / tCand if tCand > 0 else float('inf')))
+    print('steps/event  : {:.1f} reference, {:.1f} candidate'.format(ref['nSteps'].mean(), cand['nSteps'].mean()))
+    print('alpha        : {:.3g} ({} tests, Bonferroni)'.format(alpha, len(results)))
+    print('AD resamples : {}'.format(nResamples))
+    print('result       : {}'.format('FAIL ({} tests)'.format(len(failed)) if failed else 'PASS'))
+    return 1 if failed else 0
+
+if __name__ == '__main__':
+    sys.exit(main())